@@ -58,6 +58,18 @@ parser.add_option("--functional", type="int", default=0,
                   help="percentage of accesses that should be functional")
 parser.add_option("--suppress-func-warnings", action="store_true",
                   help="suppress warnings when functional accesses fail")
+parser.add_option("--spm-test", action="store_true", default=False,
+                  help="stress the scratchpads instead of the caches, "
+                  "needs the MESI_Two_Level_SPM protocol")
+parser.add_option("--spm-remote", type="int", default=25,
+                  help="percentage of scratchpad accesses that go to "
+                  "another cpu's scratchpad [default: %default]")
+parser.add_option("--spm-dma", type="int", default=5,
+                  help="percentage of ticks that start a DMA transfer "
+                  "[default: %default]")
+parser.add_option("--spm-dma-base", type="string", default="0x100000",
+                  help="memory the DMA transfers stage through, declared "
+                  "non-coherent [default: %default]")
 
 #
 # Add the ruby specific and protocol specific options
@@ -87,6 +99,16 @@ if args:
 
 block_size = 64
 
+if options.spm_test:
+    if buildEnv['PROTOCOL'] != 'MESI_Two_Level_SPM':
+        print "Error: --spm-test requires the MESI_Two_Level_SPM protocol"
+        sys.exit(1)
+    spm_test_size = MemorySize(options.spm_size).value
+    spm_dma_base = long(options.spm_dma_base, 0)
+    # Only the DMA engines reach the staging area
+    options.spm_noncoherent.append("%#x:%d" % (spm_dma_base,
+        options.num_cpus * spm_test_size / 2))
+
 if options.num_cpus > block_size:
      print "Error: Number of testers %d limited to %d because of false sharing" \
            % (options.num_cpus, block_size)
@@ -104,8 +126,22 @@ cpus = [ MemTest(atomic = False,
                  suppress_func_warnings = options.suppress_func_warnings) \
          for i in xrange(options.num_cpus) ]
 
+if options.spm_test:
+    for cpu in cpus:
+        cpu.spm_test = True
+        cpu.spm_size = spm_test_size
+        cpu.num_spms = options.num_cpus
+        cpu.percent_remote_spm = options.spm_remote
+        cpu.percent_spm_dma = options.spm_dma
+        cpu.spm_dma_base = spm_dma_base
+    # The shadow image has to cover the scratchpad windows
+    funcmem = SimpleMemory(in_addr_map = False,
+                           range = AddrRange(options.mem_size))
+else:
+    funcmem = SimpleMemory(in_addr_map = False)
+
 system = System(cpu = cpus,
-                funcmem = SimpleMemory(in_addr_map = False),
+                funcmem = funcmem,
                 funcbus = NoncoherentBus(),
                 physmem = SimpleMemory(),
                 clk_domain = SrcClockDomain(clock = options.sys_clock),
@@ -165,6 +201,11 @@ for (i, cpu) in enumerate(cpus):
     #
     system.ruby._cpu_ruby_ports[i].access_phys_mem = False
 
+    if options.spm_test:
+        spm = system.ruby._cpu_ruby_ports[0].spm
+        cpu.spm_base = spm.base_addr
+        cpu.spm_window = spm.window_size
+
 for (i, dma) in enumerate(dmas):
     #
     # Tie the dma memtester ports to the correct functional port
@@ -0,0 +1,264 @@
+# Copyright (c) 2006-2007 The Regents of The University of Michigan
+# Copyright (c) 2009 Advanced Micro Devices, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: Brad Beckmann
+
+import math
+import m5
+from m5.objects import *
+from m5.defines import buildEnv
+from Ruby import create_topology
+
+class L1Spm(RubySpm):
+    latency = 3
+
+#
+# Note: the L1 Cache latency is only used by the sequencer on fast path hits
+#
+class L1Cache(RubyCache):
+    latency = 3
+
+#
+# Note: the L2 Cache latency is not currently used
+#
+class L2Cache(RubyCache):
+    latency = 15
+
+def define_options(parser):
+    parser.add_option("--spm-size", type="string", default="16kB",
+                      help="capacity of each cpu's L1 scratchpad")
+    parser.add_option("--spm-latency", type="int", default=3,
+                      help="cycles for a local scratchpad access")
+    parser.add_option("--spm-base", type="string", default=None,
+                      help="start of the first scratchpad window, defaults "
+                      "to just below the top of physical memory")
+    parser.add_option("--spm-window", type="string", default=None,
+                      help="address space reserved per scratchpad, defaults "
+                      "to room for SPMCONFIG to borrow all but one L1D way")
+    parser.add_option("--spm-banks", type="int", default=1,
+                      help="number of banks in each scratchpad")
+    parser.add_option("--spm-interleave", type="choice", default="line",
+                      choices=["word", "line"],
+                      help="granularity at which the banks are interleaved")
+    parser.add_option("--spm-ports-per-bank", type="int", default=1,
+                      help="accesses each bank can start per cycle")
+    parser.add_option("--spm-parallel-probe", action="store_true",
+                      default=False,
+                      help="probe the scratchpad and the L1D in the same "
+                      "cycle, at the latency of the slower of the two")
+    parser.add_option("--spm-noncoherent", action="append", default=[],
+                      metavar="BASE:SIZE",
+                      help="memory range only reached through scratchpad "
+                      "DMA, moved without L2 blocks or directory owners; "
+                      "may be given more than once")
+    return
+
+def create_system(options, system, piobus, dma_ports, ruby_system):
+
+    if buildEnv['PROTOCOL'] != 'MESI_Two_Level_SPM':
+        fatal("This script requires the MESI_Two_Level_SPM protocol to be "
+              "built.")
+
+    cpu_sequencers = []
+
+    #
+    # The ruby network creation expects the list of nodes in the system to be
+    # consistent with the NetDest list.  Therefore the l1 controller nodes must be
+    # listed before the directory nodes and directory nodes before dma nodes, etc.
+    #
+    l1_cntrl_nodes = []
+    l2_cntrl_nodes = []
+    dir_cntrl_nodes = []
+    dma_cntrl_nodes = []
+
+    #
+    # Must create the individual controllers before the network to ensure the
+    # controller constructors are called before the network constructor
+    #
+    l2_bits = int(math.log(options.num_l2caches, 2))
+    block_size_bits = int(math.log(options.cacheline_size, 2))
+
+    #
+    # Each cpu's spm shadows a private window, by default carved from the
+    # top of physical memory.  The default window leaves room for
+    # SPMCONFIG to hand all but one of the L1D ways to the spm.
+    #
+    phys_mem_size = sum(map(lambda r: r.size(), system.mem_ranges))
+    spm_size = MemorySize(options.spm_size).value
+    if options.spm_window:
+        spm_window = MemorySize(options.spm_window).value
+    else:
+        l1d_way_size = MemorySize(options.l1d_size).value / options.l1d_assoc
+        spm_window = spm_size + (options.l1d_assoc - 1) * l1d_way_size
+    if spm_window < spm_size:
+        fatal("--spm-window must be at least --spm-size.")
+    if options.spm_base:
+        spm_base = long(options.spm_base, 0)
+    else:
+        spm_base = phys_mem_size - options.num_cpus * spm_window
+
+    spm_noncoherent = []
+    for r in options.spm_noncoherent:
+        base, size = r.split(':')
+        spm_noncoherent.append(AddrRange(long(base, 0), size = size))
+
+    for i in xrange(options.num_cpus):
+        #
+        # First create the Ruby objects associated with this cpu
+        #
+        l1i_cache = L1Cache(size = options.l1i_size,
+                            assoc = options.l1i_assoc,
+                            start_index_bit = block_size_bits,
+                            is_icache = True)
+        l1d_cache = L1Cache(size = options.l1d_size,
+                            assoc = options.l1d_assoc,
+                            start_index_bit = block_size_bits,
+                            is_icache = False)
+        l1d_spm = L1Spm(size = spm_size,
+                        latency = options.spm_latency,
+                        num_banks = options.spm_banks,
+                        bank_interleave = options.spm_interleave,
+                        ports_per_bank = options.spm_ports_per_bank,
+                        base_addr = spm_base + i * spm_window,
+                        window_size = spm_window,
+                        noncoherent_ranges = spm_noncoherent,
+                        cache = l1d_cache)
+        l1d_dma = SpmDMAEngine(spm = l1d_spm)
+
+        prefetcher = RubyPrefetcher.Prefetcher()
+
+        l1_cntrl = L1Cache_Controller(version = i,
+                                      L1Icache = l1i_cache,
+                                      L1Dcache = l1d_cache,
+                                      L1Dspm = l1d_spm,
+                                      L1Ddma = l1d_dma,
+                                      l2_select_num_bits = l2_bits,
+                                      send_evictions = (
+                                          options.cpu_type == "detailed"),
+                                      prefetcher = prefetcher,
+                                      ruby_system = ruby_system,
+                                      transitions_per_cycle=options.ports,
+                                      enable_prefetch = False)
+
+        cpu_seq = RubySequencer(version = i,
+                                icache = l1i_cache,
+                                dcache = l1d_cache,
+                                spm = l1d_spm,
+                                parallel_spm_probe = options.spm_parallel_probe,
+                                ruby_system = ruby_system)
+
+        l1_cntrl.sequencer = cpu_seq
+
+        if piobus != None:
+            cpu_seq.pio_port = piobus.slave
+
+        exec("ruby_system.l1_cntrl%d = l1_cntrl" % i)
+
+        #
+        # Add controllers and sequencers to the appropriate lists
+        #
+        cpu_sequencers.append(cpu_seq)
+        l1_cntrl_nodes.append(l1_cntrl)
+
+    l2_index_start = block_size_bits + l2_bits
+
+    for i in xrange(options.num_l2caches):
+        #
+        # First create the Ruby objects associated with this cpu
+        #
+        l2_cache = L2Cache(size = options.l2_size,
+                           assoc = options.l2_assoc,
+                           start_index_bit = l2_index_start)
+
+        l2_cntrl = L2Cache_Controller(version = i,
+                                      L2cache = l2_cache,
+                                      transitions_per_cycle=options.ports,
+                                      ruby_system = ruby_system)
+
+        exec("ruby_system.l2_cntrl%d = l2_cntrl" % i)
+        l2_cntrl_nodes.append(l2_cntrl)
+
+    assert(phys_mem_size % options.num_dirs == 0)
+    mem_module_size = phys_mem_size / options.num_dirs
+
+    # Run each of the ruby memory controllers at a ratio of the frequency of
+    # the ruby system
+    # clk_divider value is a fix to pass regression.
+    ruby_system.memctrl_clk_domain = DerivedClockDomain(
+                                          clk_domain=ruby_system.clk_domain,
+                                          clk_divider=3)
+
+    for i in xrange(options.num_dirs):
+        #
+        # Create the Ruby objects associated with the directory controller
+        #
+
+        mem_cntrl = RubyMemoryControl(
+                              clk_domain = ruby_system.memctrl_clk_domain,
+                              version = i,
+                              ruby_system = ruby_system)
+
+        dir_size = MemorySize('0B')
+        dir_size.value = mem_module_size
+
+        dir_cntrl = Directory_Controller(version = i,
+                                         directory = \
+                                         RubyDirectoryMemory(version = i,
+                                                             size = dir_size,
+                                                             use_map =
+                                                           options.use_map),
+                                         memBuffer = mem_cntrl,
+                                         transitions_per_cycle = options.ports,
+                                         ruby_system = ruby_system)
+
+        exec("ruby_system.dir_cntrl%d = dir_cntrl" % i)
+        dir_cntrl_nodes.append(dir_cntrl)
+
+    for i, dma_port in enumerate(dma_ports):
+        #
+        # Create the Ruby objects associated with the dma controller
+        #
+        dma_seq = DMASequencer(version = i,
+                               ruby_system = ruby_system)
+
+        dma_cntrl = DMA_Controller(version = i,
+                                   dma_sequencer = dma_seq,
+                                   transitions_per_cycle = options.ports,
+                                   ruby_system = ruby_system)
+
+        exec("ruby_system.dma_cntrl%d = dma_cntrl" % i)
+        exec("ruby_system.dma_cntrl%d.dma_sequencer.slave = dma_port" % i)
+        dma_cntrl_nodes.append(dma_cntrl)
+
+    all_cntrls = l1_cntrl_nodes + \
+                 l2_cntrl_nodes + \
+                 dir_cntrl_nodes + \
+                 dma_cntrl_nodes
+
+    topology = create_topology(all_cntrls, options)
+
+    return (cpu_sequencers, dir_cntrl_nodes, topology)
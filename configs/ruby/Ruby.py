@@ -64,6 +64,14 @@ def define_options(parser):
                       help="the number of rows in the mesh topology")
     parser.add_option("--garnet-network", type="choice",
                       choices=['fixed', 'flexible'], help="'fixed'|'flexible'")
+    parser.add_option("--garnet-routing", type="choice", default="table",
+                      choices=['table', 'xy', 'yx', 'west_first',
+                               'minimal_adaptive'],
+                      help="route computation in the fixed garnet network")
+    parser.add_option("--garnet-bypass-hops", type="int", default=0,
+                      help="routers a flit may cross in one link latency "
+                           "without being buffered in the fixed garnet "
+                           "network")
     parser.add_option("--network-fault-model", action="store_true", default=False,
                       help="enable network fault model: see src/mem/ruby/network/fault_model/")
 
@@ -75,6 +83,17 @@ def define_options(parser):
     # ruby sparse memory options
     parser.add_option("--use-map", action="store_true", default=False)
     parser.add_option("--map-levels", type="int", default=4)
+    parser.add_option("--dir-pages", action="store_true", default=False,
+                      help="allocate directory entries a page at a time, "
+                           "on first touch, instead of all at startup")
+
+    # l2 sharer tracking, used by protocols that keep a SharerSet per line
+    parser.add_option("--sharer-pointers", type="int", default=0,
+                      help="L1 sharers an L2 line tracks by id, "
+                           "0 = full bit vector")
+    parser.add_option("--sharer-vector-bits", type="int", default=0,
+                      help="coarse vector an L2 line falls back to once "
+                           "its sharer pointers overflow, 0 = broadcast")
 
     parser.add_option("--recycle-latency", type="int", default=10,
                       help="Recycle latency for ruby controller input buffers")
@@ -84,6 +103,13 @@ def define_options(parser):
 
     parser.add_option("--ruby_stats", type="string", default="ruby.stats")
 
+    # spm placement profiling
+    parser.add_option("--spm-profile", action="store_true", default=False,
+                      help="profile data accesses and suggest what to map "
+                           "onto a scratchpad")
+    parser.add_option("--spm-profile-size", type="string", default="16kB",
+                      help="capacity of the scratchpad to plan for")
+
     protocol = buildEnv['PROTOCOL']
     exec "import %s" % protocol
     eval("%s.define_options(parser)" % protocol)
@@ -101,7 +127,9 @@ def create_topology(controllers, options):
 def create_system(options, system, piobus = None, dma_ports = []):
 
     system.ruby = RubySystem(stats_filename = options.ruby_stats,
-                             no_mem_vec = options.use_map)
+                             no_mem_vec = options.use_map,
+                             sharer_pointers = options.sharer_pointers,
+                             sharer_vector_bits = options.sharer_vector_bits)
     ruby = system.ruby
 
     protocol = buildEnv['PROTOCOL']
@@ -114,6 +142,16 @@ def create_system(options, system, piobus = None, dma_ports = []):
         print "Error: could not create sytem for ruby protocol %s" % protocol
         raise
 
+    if options.spm_profile:
+        for seq in cpu_sequencers:
+            if isinstance(seq, RubySequencer):
+                seq.spm_profiler = SpmPlacementProfiler(
+                    spm_size = options.spm_profile_size)
+
+    if options.dir_pages:
+        for dir_cntrl in dir_cntrls:
+            dir_cntrl.directory.use_pages = True
+
     # Create a port proxy for connecting the system port. This is
     # independent of the protocol and kept in the protocol-agnostic
     # part (i.e. here).
@@ -152,6 +190,11 @@ def create_system(options, system, piobus = None, dma_ports = []):
     topology.makeTopology(options, network, IntLinkClass, ExtLinkClass,
                           RouterClass)
 
+    if options.garnet_network == "fixed":
+        network.routing_algorithm = options.garnet_routing
+        network.mesh_rows = options.mesh_rows
+        network.max_bypass_hops = options.garnet_bypass_hops
+
     if options.network_fault_model:
         assert(options.garnet_network == "fixed")
         network.enable_fault_model = True
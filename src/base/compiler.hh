@@ -52,6 +52,7 @@
 #define M5_VAR_USED __attribute__((unused))
 #define M5_ATTR_PACKED __attribute__ ((__packed__))
 #define M5_NO_INLINE __attribute__ ((__noinline__))
+#define M5_ATTR_ALIGNED(x) __attribute__ ((__aligned__(x)))
 #else
 #error "Need to define compiler options in base/compiler.hh"
 #endif
@@ -49,6 +49,22 @@ class MemTest(MemObject):
         "progress report interval (in accesses)")
     trace_addr = Param.Addr(0, "address to trace")
 
+    # SPM stress mode, one tester per cpu and scratchpad
+    spm_test = Param.Bool(False, "stress the scratchpads with a random mix "
+        "of local, remote and DMA traffic")
+    spm_base = Param.Addr(0, "start of the first scratchpad window")
+    spm_window = Param.MemorySize("0", "address space between windows")
+    spm_size = Param.MemorySize("0", "scratchpad bytes exercised, the "
+        "first half shared by all testers, the second private to the owner")
+    num_spms = Param.Int(1, "number of scratchpads, one per tester")
+    percent_remote_spm = Param.Percent(25,
+        "percent of scratchpad accesses that go to another cpu's scratchpad")
+    percent_spm_dma = Param.Percent(5,
+        "percent of ticks that start a DMA transfer when none is in flight")
+    spm_dma_base = Param.Addr(0, "start of the memory the DMA transfers "
+        "stage through, spm_size / 2 bytes per tester")
+    spm_dma_max_lines = Param.Int(4, "most lines moved by one transfer")
+
     test = MasterPort("Port to the memory system to test")
     functional = MasterPort("Port to the functional memory " \
                                 "used for verification")
@@ -31,6 +31,7 @@
 
 // FIX ME: make trackBlkAddr use blocksize from actual cache, not hard coded
 
+#include <algorithm>
 #include <iomanip>
 #include <set>
 #include <string>
@@ -45,6 +46,7 @@
 #include "mem/port.hh"
 #include "mem/request.hh"
 #include "sim/sim_events.hh"
+#include "sim/spm_control.hh"
 #include "sim/stats.hh"
 #include "sim/system.hh"
 
@@ -96,6 +98,7 @@ MemTest::MemTest(const Params *p)
       cachePort("test", this),
       funcPort("functional", this),
       funcProxy(funcPort, p->sys->cacheLineSize()),
+      spmDmaEvent(this),
       retryPkt(NULL),
 //      mainMem(main_mem),
 //      checkMem(check_mem),
@@ -112,7 +115,16 @@ MemTest::MemTest(const Params *p)
       percentDestUnaligned(p->percent_dest_unaligned),
       maxLoads(p->max_loads),
       atomic(p->atomic),
-      suppress_func_warnings(p->suppress_func_warnings)
+      suppress_func_warnings(p->suppress_func_warnings),
+      spmTest(p->spm_test),
+      spmBase(p->spm_base),
+      spmWindow(p->spm_window),
+      numSpms(p->num_spms),
+      percentRemoteSpm(p->percent_remote_spm),
+      percentSpmDma(p->percent_spm_dma),
+      spmDmaBase(p->spm_dma_base),
+      spmDmaMaxLines(p->spm_dma_max_lines),
+      spmDmaOutstanding(false)
 {
     id = TESTER_ALLOCATOR++;
 
@@ -145,6 +157,21 @@ MemTest::MemTest(const Params *p)
 	addrList.push_back(baseAddr2 + id * SPM_MEM_TEST_SIZE + i);
     }
     issuedAddrNum = 0;
+
+    spmLines = p->spm_size / blockSize;
+    spmSharedLines = spmLines / 2;
+    if (spmTest) {
+        if (spmLines < 2 || p->spm_size % blockSize != 0)
+            fatal("%s: spm_size %d must be at least two lines and a whole "
+                  "number of lines\n", name(), p->spm_size);
+        if (spmWindow < p->spm_size)
+            fatal("%s: spm_window must be at least spm_size\n", name());
+        if (id >= numSpms || numSpms > blockSize)
+            fatal("%s: needs one scratchpad per tester and at most %d "
+                  "testers\n", name(), blockSize);
+        if (spmDmaMaxLines == 0)
+            fatal("%s: spm_dma_max_lines must be at least 1\n", name());
+    }
 }
 
 BaseMasterPort &
@@ -182,6 +209,7 @@ MemTest::completeRequest(PacketPtr pkt)
 
     MemTestSenderState *state =
         dynamic_cast<MemTestSenderState *>(pkt->senderState);
+    int spm_kind = state->spmKind;
 
     uint8_t *data = state->data;
     uint8_t *pkt_data = pkt->getPtr<uint8_t>();
@@ -208,6 +236,8 @@ MemTest::completeRequest(PacketPtr pkt)
 
             numReads++;
             numReadsStat++;
+            if (spm_kind >= 0)
+                numSpmReads[spm_kind]++;
 
             if (numReads == (uint64_t)nextProgressMessage) {
                 ccprintf(cerr, "%s: completed %d read, %d write accesses @%d\n",
@@ -222,7 +252,11 @@ MemTest::completeRequest(PacketPtr pkt)
             funcProxy.writeBlob(req->getPaddr(), pkt_data, req->getSize());
             numWrites++;
             numWritesStat++;
+            if (spm_kind >= 0)
+                numSpmWrites[spm_kind]++;
         }
+        if (spm_kind >= 0)
+            spmLatency[spm_kind].sample(curTick() - state->issueTick);
     }
 
     noResponseCycles = 0;
@@ -251,6 +285,67 @@ MemTest::regStats()
         .name(name() + ".num_copies")
         .desc("number of copy accesses completed")
         ;
+
+    numSpmReads
+        .init(NumSpmAccessKinds)
+        .name(name() + ".spm_reads")
+        .desc("number of scratchpad reads completed")
+        .subname(SpmLocal, "local")
+        .subname(SpmRemote, "remote")
+        .flags(total | nozero)
+        ;
+
+    numSpmWrites
+        .init(NumSpmAccessKinds)
+        .name(name() + ".spm_writes")
+        .desc("number of scratchpad writes completed")
+        .subname(SpmLocal, "local")
+        .subname(SpmRemote, "remote")
+        .flags(total | nozero)
+        ;
+
+    const char *kind_names[NumSpmAccessKinds] = { "local", "remote" };
+    for (int i = 0; i < NumSpmAccessKinds; i++) {
+        spmLatency[i]
+            .init(0, 4999, 100)
+            .name(name() + ".spm_" + kind_names[i] + "_latency")
+            .desc("ticks from issue to completion of a scratchpad access")
+            .flags(nozero)
+            ;
+    }
+
+    numSpmDmas
+        .name(name() + ".spm_dmas")
+        .desc("number of scratchpad DMA transfers completed")
+        .flags(nozero)
+        ;
+
+    numSpmDmaBytes
+        .name(name() + ".spm_dma_bytes")
+        .desc("bytes moved by scratchpad DMA transfers")
+        .flags(nozero)
+        ;
+
+    spmDmaLatency
+        .init(0, 99999, 1000)
+        .name(name() + ".spm_dma_latency")
+        .desc("ticks from start to completion of a DMA transfer")
+        .flags(nozero)
+        ;
+
+    spmAccessRate
+        .name(name() + ".spm_access_rate")
+        .desc("scratchpad accesses completed per simulated second")
+        .flags(nozero)
+        ;
+    spmAccessRate = (numSpmReads.total() + numSpmWrites.total()) / simSeconds;
+
+    spmDmaBandwidth
+        .name(name() + ".spm_dma_bandwidth")
+        .desc("bytes per simulated second moved by DMA transfers")
+        .flags(nozero)
+        ;
+    spmDmaBandwidth = numSpmDmaBytes / simSeconds;
 }
 
 void
@@ -272,6 +367,11 @@ MemTest::tick()
         return;
     }
 
+    if (spmTest) {
+        tickSpm();
+        return;
+    }
+
     //make new request
     unsigned cmd = random() % 100;
     unsigned offset = random() % size;
@@ -390,6 +490,126 @@ MemTest::tick()
     }
 }
 
+void
+MemTest::tickSpm()
+{
+    if (!spmDmaOutstanding && random() % 100 < percentSpmDma) {
+        startSpmDma();
+        return;
+    }
+
+    // Pick a byte this tester may touch.  Shared lines only ever see
+    // byte id from anyone, private lines only ever see their owner.
+    int kind = SpmLocal;
+    int cpu_id = id;
+    if (numSpms > 1 && random() % 100 < percentRemoteSpm) {
+        kind = SpmRemote;
+        cpu_id = (id + 1 + random() % (numSpms - 1)) % numSpms;
+    }
+    unsigned line = kind == SpmRemote ? random() % spmSharedLines :
+        random() % spmLines;
+    unsigned byte = line < spmSharedLines ? id : random() % blockSize;
+    Addr paddr = spmAddr(cpu_id) + line * blockSize + byte;
+
+    // One access per address, and none to lines a transfer owns
+    if (outstandingAddrs.find(paddr) != outstandingAddrs.end() ||
+        spmDmaBusy(paddr)) {
+        return;
+    }
+    outstandingAddrs.insert(paddr);
+
+    Request *req = new Request();
+    req->setPhys(paddr, 1, Request::Flags(), masterId);
+    req->setThreadContext(id, 0);
+    uint8_t *result = new uint8_t[8];
+    MemTestSenderState *state = new MemTestSenderState(result, kind);
+
+    PacketPtr pkt;
+    if (random() % 100 < percentReads) {
+        funcProxy.readBlob(paddr, result, 1);
+        DPRINTF(MemTest, "id %d initiating %s spm read at addr %x "
+                "expecting %x\n", id, kind == SpmRemote ? "remote" : "local",
+                paddr, *result);
+        pkt = new Packet(req, MemCmd::ReadReq);
+        pkt->dataDynamicArray(new uint8_t[1]);
+    } else {
+        uint8_t *pkt_data = new uint8_t[1];
+        pkt_data[0] = random();
+        DPRINTF(MemTest, "id %d initiating %s spm write at addr %x "
+                "value %x\n", id, kind == SpmRemote ? "remote" : "local",
+                paddr, pkt_data[0]);
+        pkt = new Packet(req, MemCmd::WriteReq);
+        pkt->dataDynamicArray(pkt_data);
+    }
+    pkt->senderState = state;
+    sendPkt(pkt);
+}
+
+void
+MemTest::startSpmDma()
+{
+    SpmControl *spm = SpmControl::lookup(id);
+    if (spm == NULL)
+        fatal("%s: cpu %d has no scratchpad\n", name(), id);
+
+    unsigned private_lines = spmLines - spmSharedLines;
+    unsigned lines = 1 + random() % min(spmDmaMaxLines, private_lines);
+    Addr spm_addr = spmAddr(id) +
+        (spmSharedLines + random() % (private_lines - lines + 1)) * blockSize;
+    Addr mem_addr = spmDmaBase + id * private_lines * blockSize +
+        (random() % (private_lines - lines + 1)) * blockSize;
+    unsigned length = lines * blockSize;
+
+    // Wait for accesses to the lines to drain first
+    for (set<unsigned>::iterator it = outstandingAddrs.begin();
+         it != outstandingAddrs.end(); ++it) {
+        if (*it >= spm_addr && *it < spm_addr + length)
+            return;
+    }
+
+    spmDmaMoveIn = random() % 2;
+    spmDmaSpmAddr = spm_addr;
+    spmDmaMemAddr = mem_addr;
+    spmDmaLength = length;
+    spmDmaStart = curTick();
+    spmDmaId = spmDmaMoveIn ?
+        spm->startDma(mem_addr, spm_addr, length, blockSize, true) :
+        spm->startDma(spm_addr, mem_addr, length, blockSize, false);
+    if (spmDmaId < 0)
+        fatal("%s: scratchpad rejected a transfer of %d lines\n", name(),
+              lines);
+    spmDmaOutstanding = true;
+
+    DPRINTF(MemTest, "id %d initiating spm dma %d %s, %d bytes spm %x "
+            "mem %x\n", id, spmDmaId, spmDmaMoveIn ? "in" : "out", length,
+            spm_addr, mem_addr);
+
+    if (spm->waitDma(spmDmaId, &spmDmaEvent))
+        completeSpmDma();
+}
+
+void
+MemTest::completeSpmDma()
+{
+    assert(spmDmaOutstanding);
+    DPRINTF(MemTest, "id %d completing spm dma %d\n", id, spmDmaId);
+
+    // Nobody else touches either side while the transfer is in flight,
+    // so the shadow image can be brought up to date all at once
+    uint8_t *data = new uint8_t[spmDmaLength];
+    Addr src = spmDmaMoveIn ? spmDmaMemAddr : spmDmaSpmAddr;
+    Addr dst = spmDmaMoveIn ? spmDmaSpmAddr : spmDmaMemAddr;
+    funcProxy.readBlob(src, data, spmDmaLength);
+    funcProxy.writeBlob(dst, data, spmDmaLength);
+    delete [] data;
+
+    numSpmDmas++;
+    numSpmDmaBytes += spmDmaLength;
+    spmDmaLatency.sample(curTick() - spmDmaStart);
+    noResponseCycles = 0;
+    spmDmaOutstanding = false;
+}
+
 void
 MemTest::doRetry()
 {
@@ -116,14 +116,31 @@ class MemTest : public MemObject
     {
       public:
         /** Constructor. */
-        MemTestSenderState(uint8_t *_data)
-            : data(_data)
+        MemTestSenderState(uint8_t *_data, int _spmKind = -1)
+            : data(_data), spmKind(_spmKind), issueTick(curTick())
         { }
 
         // Hold onto data pointer
         uint8_t *data;
+
+        // SpmAccessKind of a scratchpad access, -1 otherwise
+        int spmKind;
+        Tick issueTick;
     };
 
+    class SpmDmaEvent : public Event
+    {
+      private:
+        MemTest *cpu;
+
+      public:
+        SpmDmaEvent(MemTest *c) : cpu(c) {}
+        void process() { cpu->completeSpmDma(); }
+        virtual const char *description() const { return "MemTest SPM DMA"; }
+    };
+
+    SpmDmaEvent spmDmaEvent;
+
     PacketPtr retryPkt;
 
     bool accessRetry;
@@ -182,10 +199,68 @@ class MemTest : public MemObject
     bool atomic;
     bool suppress_func_warnings;
 
+    /**
+     * SPM stress mode.  Tester i stands in for cpu i and owns its
+     * scratchpad.  The first half of every scratchpad is shared: tester i
+     * only touches byte i of each line there, from its own cpu or from
+     * another one.  The second half is private to the owner, which also
+     * moves it to and from a staging area in memory with the DMA engine.
+     * Like the other modes, data is checked against the functional
+     * memory, which the testers keep as a shadow image.
+     */
+    enum SpmAccessKind {
+        SpmLocal,
+        SpmRemote,
+        NumSpmAccessKinds
+    };
+
+    bool spmTest;
+    Addr spmBase;
+    Addr spmWindow;
+    unsigned spmLines;
+    unsigned spmSharedLines;
+    int numSpms;
+    unsigned percentRemoteSpm;
+    unsigned percentSpmDma;
+    Addr spmDmaBase;
+    unsigned spmDmaMaxLines;
+
+    // The one transfer a tester keeps in flight
+    bool spmDmaOutstanding;
+    int spmDmaId;
+    bool spmDmaMoveIn;
+    Addr spmDmaSpmAddr;
+    Addr spmDmaMemAddr;
+    unsigned spmDmaLength;
+    Tick spmDmaStart;
+
+    // first byte of the scratchpad of cpu cpu_id
+    Addr spmAddr(int cpu_id) const { return spmBase + cpu_id * spmWindow; }
+
+    // true if addr is in a scratchpad line the transfer in flight owns
+    bool spmDmaBusy(Addr addr) const
+    {
+        return spmDmaOutstanding && addr >= spmDmaSpmAddr &&
+            addr < spmDmaSpmAddr + spmDmaLength;
+    }
+
+    void tickSpm();
+    void startSpmDma();
+    void completeSpmDma();
+
     Stats::Scalar numReadsStat;
     Stats::Scalar numWritesStat;
     Stats::Scalar numCopiesStat;
 
+    Stats::Vector numSpmReads;
+    Stats::Vector numSpmWrites;
+    Stats::Distribution spmLatency[NumSpmAccessKinds];
+    Stats::Scalar numSpmDmas;
+    Stats::Scalar numSpmDmaBytes;
+    Stats::Distribution spmDmaLatency;
+    Stats::Formula spmAccessRate;
+    Stats::Formula spmDmaBandwidth;
+
     // called by MemCompleteEvent::process()
     void completeRequest(PacketPtr pkt);
 
@@ -58,7 +58,6 @@ MessageBuffer::MessageBuffer(const string &name)
     m_priority_rank = 0;
     m_name = name;
 
-    m_stall_msg_map.clear();
     m_input_link_id = 0;
     m_vnet_id = 0;
 }
@@ -312,62 +311,50 @@ MessageBuffer::recycle()
 }
 
 void
-MessageBuffer::reanalyzeMessages(const Address& addr)
+MessageBuffer::requeueWoken()
 {
-    DPRINTF(RubyQueue, "ReanalyzeMessages\n");
-    assert(m_stall_msg_map.count(addr) > 0);
     Tick nextTick = m_receiver->clockEdge(Cycles(1));
 
     //
-    // Put all stalled messages associated with this address back on the
-    // prio heap
+    // Put the released messages back on the prio heap in the order they
+    // were stalled
     //
-    while(!m_stall_msg_map[addr].empty()) {
+    for (vector<MsgPtr>::iterator it = m_woken.begin(); it != m_woken.end();
+         ++it) {
         m_msg_counter++;
-        MessageBufferNode msgNode(nextTick, m_msg_counter,
-                                  m_stall_msg_map[addr].front());
+        MessageBufferNode msgNode(nextTick, m_msg_counter, *it);
 
         m_prio_heap.push_back(msgNode);
         push_heap(m_prio_heap.begin(), m_prio_heap.end(),
                   greater<MessageBufferNode>());
-
-        m_consumer->scheduleEventAbsolute(nextTick);
-        m_stall_msg_map[addr].pop_front();
     }
-    m_stall_msg_map.erase(addr);
+    if (!m_woken.empty())
+        m_consumer->scheduleEventAbsolute(nextTick);
+    m_woken.clear();
 }
 
-void
-MessageBuffer::reanalyzeAllMessages()
+int
+MessageBuffer::reanalyzeMessages(const Address& addr)
 {
-    DPRINTF(RubyQueue, "ReanalyzeAllMessages\n");
-    Tick nextTick = m_receiver->clockEdge(Cycles(1));
-
-    //
-    // Put all stalled messages associated with this address back on the
-    // prio heap
-    //
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
+    DPRINTF(RubyQueue, "ReanalyzeMessages\n");
+    assert(m_stall_map.contains(addr));
 
-        while(!(map_iter->second).empty()) {
-            m_msg_counter++;
-            MessageBufferNode msgNode(nextTick, m_msg_counter,
-                                      (map_iter->second).front());
+    int count = m_stall_map.release(addr, m_woken);
+    requeueWoken();
+    return count;
+}
 
-            m_prio_heap.push_back(msgNode);
-            push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      greater<MessageBufferNode>());
+int
+MessageBuffer::reanalyzeAllMessages()
+{
+    DPRINTF(RubyQueue, "ReanalyzeAllMessages\n");
 
-            m_consumer->scheduleEventAbsolute(nextTick);
-            (map_iter->second).pop_front();
-        }
-    }
-    m_stall_msg_map.clear();
+    int count = m_stall_map.releaseAll(m_woken);
+    requeueWoken();
+    return count;
 }
 
-void
+int
 MessageBuffer::stallMessage(const Address& addr)
 {
     DPRINTF(RubyQueue, "Stalling due to %s\n", addr);
@@ -382,7 +369,7 @@ MessageBuffer::stallMessage(const Address& addr)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    return m_stall_map.push(addr, message);
 }
 
 Cycles
@@ -440,18 +427,7 @@ MessageBuffer::functionalRead(Packet *pkt)
 
     // Read the messages in the stall queue that correspond
     // to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (msg->functionalRead(pkt)) return true;
-        }
-    }
-    return false;
+    return m_stall_map.functionalRead(pkt);
 }
 
 uint32_t
@@ -470,19 +446,7 @@ MessageBuffer::functionalWrite(Packet *pkt)
 
     // Check the stall queue and write any messages that may
     // correspond to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (msg->functionalWrite(pkt)) {
-                num_functional_writes++;
-            }
-        }
-    }
+    num_functional_writes += m_stall_map.functionalWrite(pkt);
 
     return num_functional_writes;
 }
@@ -43,6 +43,7 @@
 
 #include "mem/packet.hh"
 #include "mem/ruby/buffers/MessageBufferNode.hh"
+#include "mem/ruby/buffers/StallMap.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
@@ -57,9 +58,11 @@ class MessageBuffer
     void setRecycleLatency(Cycles recycle_latency)
     { m_recycle_latency = recycle_latency; }
 
-    void reanalyzeMessages(const Address& addr);
-    void reanalyzeAllMessages();
-    void stallMessage(const Address& addr);
+    // Both return the number of messages put back in the buffer
+    int reanalyzeMessages(const Address& addr);
+    int reanalyzeAllMessages();
+    // Returns the number of messages now waiting on addr
+    int stallMessage(const Address& addr);
 
     // TRUE if head of queue timestamp <= SystemTime
     bool isReady() const;
@@ -171,6 +174,8 @@ class MessageBuffer
 
     // Private Methods
     Cycles setAndReturnDelayCycles(MsgPtr message);
+    // move m_woken onto the prio heap, ready next cycle
+    void requeueWoken();
 
     // Private copy constructor and assignment operator
     MessageBuffer(const MessageBuffer& obj);
@@ -185,12 +190,10 @@ class MessageBuffer
     Consumer* m_consumer;
     std::vector<MessageBufferNode> m_prio_heap;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map< Address, std::list<MsgPtr> > StallMsgMapType;
-    typedef std::vector<MsgPtr>::iterator MsgListIter;
-
-    StallMsgMapType m_stall_msg_map;
+    // Stalled messages, one wait list per line
+    StallMap m_stall_map;
+    // Messages on their way back from m_stall_map, kept to reuse its space
+    std::vector<MsgPtr> m_woken;
     std::string m_name;
 
     unsigned int m_max_size;
@@ -0,0 +1,227 @@
+#include "mem/ruby/buffers/StallMap.hh"
+
+using namespace std;
+
+StallMap::StallMap()
+    : m_slots(1 << InitialSlotBits, -1), m_slot_bits(InitialSlotBits),
+      m_num_lists(0), m_free_list(-1), m_free_node(-1), m_oldest(-1),
+      m_newest(-1)
+{
+}
+
+int
+StallMap::findSlot(const Address& addr) const
+{
+    unsigned mask = m_slots.size() - 1;
+    for (unsigned i = home(addr); ; i = (i + 1) & mask) {
+        int l = m_slots[i];
+        if (l < 0)
+            return -1;
+        if (m_lists[l].addr == addr)
+            return i;
+    }
+}
+
+int
+StallMap::freeSlot(const Address& addr) const
+{
+    unsigned mask = m_slots.size() - 1;
+    unsigned i = home(addr);
+    while (m_slots[i] >= 0)
+        i = (i + 1) & mask;
+    return i;
+}
+
+void
+StallMap::eraseSlot(int slot)
+{
+    // Shift back any entry further down the probe run that could not be
+    // found once the slot is empty
+    unsigned mask = m_slots.size() - 1;
+    unsigned hole = slot;
+    m_slots[hole] = -1;
+    for (unsigned i = (hole + 1) & mask; m_slots[i] >= 0;
+         i = (i + 1) & mask) {
+        unsigned h = home(m_lists[m_slots[i]].addr);
+        // the entry stays if its home lies cyclically in (hole, i]
+        bool stays = hole < i ? (h > hole && h <= i) : (h > hole || h <= i);
+        if (!stays) {
+            m_slots[hole] = m_slots[i];
+            m_slots[i] = -1;
+            hole = i;
+        }
+    }
+}
+
+void
+StallMap::grow()
+{
+    m_slot_bits++;
+    m_slots.assign(1 << m_slot_bits, -1);
+    for (int l = m_oldest; l >= 0; l = m_lists[l].newer)
+        m_slots[freeSlot(m_lists[l].addr)] = l;
+}
+
+int
+StallMap::allocList(const Address& addr)
+{
+    int l;
+    if (m_free_list >= 0) {
+        l = m_free_list;
+        m_free_list = m_lists[l].newer;
+    } else {
+        l = m_lists.size();
+        m_lists.push_back(WaitList());
+    }
+
+    WaitList &list = m_lists[l];
+    list.addr = addr;
+    list.head = -1;
+    list.tail = -1;
+    list.length = 0;
+    list.older = m_newest;
+    list.newer = -1;
+    if (m_newest >= 0) {
+        m_lists[m_newest].newer = l;
+    } else {
+        m_oldest = l;
+    }
+    m_newest = l;
+    m_num_lists++;
+    return l;
+}
+
+int
+StallMap::allocNode(const MsgPtr& msg)
+{
+    int n;
+    if (m_free_node >= 0) {
+        n = m_free_node;
+        m_free_node = m_nodes[n].next;
+    } else {
+        n = m_nodes.size();
+        m_nodes.push_back(WaitNode());
+    }
+    m_nodes[n].msg = msg;
+    m_nodes[n].next = -1;
+    return n;
+}
+
+int
+StallMap::push(const Address& addr, const MsgPtr& msg)
+{
+    int slot = findSlot(addr);
+    int l;
+    if (slot >= 0) {
+        l = m_slots[slot];
+    } else {
+        // keep the table at most half full
+        if (2 * (m_num_lists + 1) > (int)m_slots.size())
+            grow();
+        l = allocList(addr);
+        m_slots[freeSlot(addr)] = l;
+    }
+
+    int n = allocNode(msg);
+    WaitList &list = m_lists[l];
+    if (list.tail >= 0) {
+        m_nodes[list.tail].next = n;
+    } else {
+        list.head = n;
+    }
+    list.tail = n;
+    return ++list.length;
+}
+
+int
+StallMap::drain(int l, vector<MsgPtr>& out)
+{
+    WaitList &list = m_lists[l];
+    int count = list.length;
+    int n = list.head;
+    while (n >= 0) {
+        WaitNode &node = m_nodes[n];
+        out.push_back(node.msg);
+        node.msg = NULL;
+        int next = node.next;
+        node.next = m_free_node;
+        m_free_node = n;
+        n = next;
+    }
+
+    if (list.older >= 0) {
+        m_lists[list.older].newer = list.newer;
+    } else {
+        m_oldest = list.newer;
+    }
+    if (list.newer >= 0) {
+        m_lists[list.newer].older = list.older;
+    } else {
+        m_newest = list.older;
+    }
+    list.head = -1;
+    list.tail = -1;
+    list.newer = m_free_list;
+    m_free_list = l;
+    m_num_lists--;
+    return count;
+}
+
+int
+StallMap::release(const Address& addr, vector<MsgPtr>& out)
+{
+    int slot = findSlot(addr);
+    if (slot < 0)
+        return 0;
+    int l = m_slots[slot];
+    eraseSlot(slot);
+    return drain(l, out);
+}
+
+int
+StallMap::releaseAll(vector<MsgPtr>& out)
+{
+    int count = 0;
+    while (m_oldest >= 0)
+        count += drain(m_oldest, out);
+    m_slots.assign(m_slots.size(), -1);
+    return count;
+}
+
+void
+StallMap::clear()
+{
+    m_slots.assign(m_slots.size(), -1);
+    m_lists.clear();
+    m_nodes.clear();
+    m_num_lists = 0;
+    m_free_list = -1;
+    m_free_node = -1;
+    m_oldest = -1;
+    m_newest = -1;
+}
+
+bool
+StallMap::functionalRead(Packet *pkt)
+{
+    for (int l = m_oldest; l >= 0; l = m_lists[l].newer) {
+        for (int n = m_lists[l].head; n >= 0; n = m_nodes[n].next) {
+            if (m_nodes[n].msg->functionalRead(pkt))
+                return true;
+        }
+    }
+    return false;
+}
+
+uint32_t
+StallMap::functionalWrite(Packet *pkt)
+{
+    uint32_t num_functional_writes = 0;
+    for (int l = m_oldest; l >= 0; l = m_lists[l].newer) {
+        for (int n = m_lists[l].head; n >= 0; n = m_nodes[n].next) {
+            if (m_nodes[n].msg->functionalWrite(pkt))
+                num_functional_writes++;
+        }
+    }
+    return num_functional_writes;
+}
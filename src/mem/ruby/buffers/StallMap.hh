@@ -0,0 +1,92 @@
+#ifndef __MEM_RUBY_BUFFERS_STALLMAP_HH__
+#define __MEM_RUBY_BUFFERS_STALLMAP_HH__
+
+#include <vector>
+
+#include "mem/packet.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+/**
+ * The messages a buffer has parked with stall_and_wait, one wait list
+ * per line.  Lists are found through an open-addressed table keyed by
+ * line address, and both lists and their messages live in pools linked
+ * by index, so stalling and waking a message costs a probe and a couple
+ * of index updates however many lines are stalled on.  Lists are also
+ * kept in the order they were opened, which is the order releaseAll()
+ * and the functional accesses visit them in.
+ */
+class StallMap
+{
+  public:
+    StallMap();
+
+    // Append msg to the wait list of addr, returns the list's new length
+    int push(const Address& addr, const MsgPtr& msg);
+    bool contains(const Address& addr) const { return findSlot(addr) >= 0; }
+    // Append the messages waiting on addr, oldest first, to out and drop
+    // the list.  Returns the number of messages released.
+    int release(const Address& addr, std::vector<MsgPtr>& out);
+    // Same for every list, oldest list first
+    int releaseAll(std::vector<MsgPtr>& out);
+
+    bool empty() const { return m_num_lists == 0; }
+    void clear();
+
+    bool functionalRead(Packet *pkt);
+    uint32_t functionalWrite(Packet *pkt);
+
+  private:
+    struct WaitList
+    {
+        Address addr;
+        // first and last message, -1 when the list is free
+        int head;
+        int tail;
+        int length;
+        // neighbours by age, newer also links free lists
+        int older;
+        int newer;
+    };
+
+    struct WaitNode
+    {
+        MsgPtr msg;
+        int next;
+    };
+
+    static const int InitialSlotBits = 4;
+
+    unsigned
+    home(const Address& addr) const
+    {
+        uint64_t h = addr.getAddress() * ULL(0x9e3779b97f4a7c15);
+        return h >> (64 - m_slot_bits);
+    }
+
+    // slot holding the list of addr, -1 if there is none
+    int findSlot(const Address& addr) const;
+    // empty slot from which addr would be found
+    int freeSlot(const Address& addr) const;
+    void eraseSlot(int slot);
+    void grow();
+
+    int allocList(const Address& addr);
+    int allocNode(const MsgPtr& msg);
+    // move the messages of list l to out and free it
+    int drain(int l, std::vector<MsgPtr>& out);
+
+    // index into m_lists, -1 for an empty slot
+    std::vector<int> m_slots;
+    unsigned m_slot_bits;
+    int m_num_lists;
+
+    std::vector<WaitList> m_lists;
+    std::vector<WaitNode> m_nodes;
+    int m_free_list;
+    int m_free_node;
+    int m_oldest;
+    int m_newest;
+};
+
+#endif // __MEM_RUBY_BUFFERS_STALLMAP_HH__
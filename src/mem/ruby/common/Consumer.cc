@@ -26,8 +26,15 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
+#include "base/bitfield.hh"
 #include "mem/ruby/common/Consumer.hh"
 
+using namespace std;
+
+uint64_t Consumer::s_num_wakeups = 0;
+
 void
 Consumer::scheduleEvent(Cycles timeDelta)
 {
@@ -37,10 +44,132 @@ Consumer::scheduleEvent(Cycles timeDelta)
 void
 Consumer::scheduleEventAbsolute(Tick evt_time)
 {
-    if (!alreadyScheduled(evt_time)) {
-        // This wakeup is not redundant
-        ConsumerEvent *evt = new ConsumerEvent(this);
-        em->schedule(evt, evt_time);
-        insertScheduledWakeupTime(evt_time);
+    if (alreadyScheduled(evt_time)) {
+        // This wakeup is redundant
+        return;
+    }
+
+    insertScheduledWakeupTime(evt_time);
+    if (m_waking) {
+        // processWakeup() picks the next wakeup once wakeup() returns
+        return;
     }
+
+    if (!m_wakeup_event.scheduled()) {
+        em->schedule(m_wakeup_event, evt_time);
+    } else if (evt_time < m_wakeup_event.when()) {
+        em->reschedule(m_wakeup_event, evt_time);
+    }
+}
+
+bool
+Consumer::alreadyScheduled(Tick time) const
+{
+    if (m_wakeup_mask != 0 && time >= m_mask_base) {
+        Tick offset = time - m_mask_base;
+        if (offset % m_mask_period == 0 && offset / m_mask_period < 64 &&
+            (m_wakeup_mask & (ULL(1) << (offset / m_mask_period)))) {
+            return true;
+        }
+    }
+    return !m_far_wakeups.empty() &&
+        binary_search(m_far_wakeups.begin(), m_far_wakeups.end(), time);
+}
+
+void
+Consumer::insertScheduledWakeupTime(Tick time)
+{
+    if (m_wakeup_mask == 0) {
+        m_mask_base = time;
+        m_mask_period = em->clockPeriod();
+        m_wakeup_mask = 1;
+        return;
+    }
+
+    if (time > m_mask_base) {
+        Tick offset = time - m_mask_base;
+        if (offset % m_mask_period == 0 && offset / m_mask_period < 64) {
+            m_wakeup_mask |= ULL(1) << (offset / m_mask_period);
+            return;
+        }
+    } else {
+        // Earlier than anything in the mask, slide the mask up if no
+        // pending bit falls off the top
+        Tick offset = m_mask_base - time;
+        if (offset % m_mask_period == 0 &&
+            offset / m_mask_period + findMsbSet(m_wakeup_mask) < 64) {
+            m_wakeup_mask = (m_wakeup_mask << (offset / m_mask_period)) | 1;
+            m_mask_base = time;
+            return;
+        }
+    }
+
+    m_far_wakeups.insert(upper_bound(m_far_wakeups.begin(),
+                                     m_far_wakeups.end(), time), time);
+}
+
+void
+Consumer::removeScheduledWakeupTime(Tick time)
+{
+    assert(time == nextWakeupTime());
+
+    if (m_wakeup_mask != 0 && m_mask_base == time) {
+        m_wakeup_mask &= ~ULL(1);
+        if (m_wakeup_mask != 0) {
+            int shift = findLsbSet(m_wakeup_mask);
+            m_wakeup_mask >>= shift;
+            m_mask_base += shift * m_mask_period;
+        }
+    } else {
+        m_far_wakeups.erase(m_far_wakeups.begin());
+    }
+
+    if (m_wakeup_mask != 0 || m_far_wakeups.empty())
+        return;
+
+    // Restart the mask at the earliest far wakeup and move over every
+    // other one that lands on it
+    m_mask_base = m_far_wakeups.front();
+    m_mask_period = em->clockPeriod();
+    m_wakeup_mask = 1;
+    vector<Tick>::iterator keep = m_far_wakeups.begin();
+    for (vector<Tick>::iterator it = m_far_wakeups.begin() + 1;
+         it != m_far_wakeups.end(); ++it) {
+        Tick offset = *it - m_mask_base;
+        if (offset % m_mask_period == 0 && offset / m_mask_period < 64) {
+            m_wakeup_mask |= ULL(1) << (offset / m_mask_period);
+        } else {
+            *keep++ = *it;
+        }
+    }
+    m_far_wakeups.erase(keep, m_far_wakeups.end());
+}
+
+Tick
+Consumer::nextWakeupTime() const
+{
+    Tick next = MaxTick;
+    if (m_wakeup_mask != 0)
+        next = m_mask_base;
+    if (!m_far_wakeups.empty() && m_far_wakeups.front() < next)
+        next = m_far_wakeups.front();
+    return next;
+}
+
+void
+Consumer::processWakeup()
+{
+    Tick now = m_wakeup_event.when();
+    s_num_wakeups++;
+
+    // A wakeup for the current tick asked for from within wakeup() is
+    // dropped, as the pending time is only cleared once it returns
+    m_waking = true;
+    wakeup();
+    m_waking = false;
+    removeScheduledWakeupTime(now);
+
+    Tick next = nextWakeupTime();
+    if (next != MaxTick)
+        em->schedule(m_wakeup_event, next);
 }
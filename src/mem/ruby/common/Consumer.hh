@@ -36,21 +36,26 @@
 #define __MEM_RUBY_COMMON_CONSUMER_HH__
 
 #include <iostream>
-#include <set>
+#include <vector>
 
+#include "base/types.hh"
 #include "sim/clocked_object.hh"
 
 class Consumer
 {
   public:
     Consumer(ClockedObject *_em)
-        : m_last_scheduled_wakeup(0), em(_em)
+        : m_last_scheduled_wakeup(0), m_wakeup_mask(0), m_mask_base(0),
+          m_mask_period(1), m_waking(false), em(_em), m_wakeup_event(this)
     {
     }
 
     virtual
     ~Consumer()
-    { }
+    {
+        if (m_wakeup_event.scheduled())
+            em->deschedule(m_wakeup_event);
+    }
 
     virtual void wakeup() = 0;
     virtual void print(std::ostream& out) const = 0;
@@ -68,52 +73,57 @@ class Consumer
         m_last_scheduled_wakeup = time;
     }
 
-    bool
-    alreadyScheduled(Tick time)
-    {
-        return m_scheduled_wakeups.find(time) != m_scheduled_wakeups.end();
-    }
-
-    void
-    insertScheduledWakeupTime(Tick time)
-    {
-        m_scheduled_wakeups.insert(time);
-    }
-
-    void
-    removeScheduledWakeupTime(Tick time)
-    {
-        assert(alreadyScheduled(time));
-        m_scheduled_wakeups.erase(time);
-    }
+    bool alreadyScheduled(Tick time) const;
 
     void scheduleEventAbsolute(Tick timeAbs);
 
+    //! Wakeups processed by every consumer in the system
+    static Counter numWakeups() { return s_num_wakeups; }
+
   protected:
     void scheduleEvent(Cycles timeDelta);
 
   private:
-    Tick m_last_scheduled_wakeup;
-    std::set<Tick> m_scheduled_wakeups;
-    ClockedObject *em;
+    void insertScheduledWakeupTime(Tick time);
+    void removeScheduledWakeupTime(Tick time);
+    //! Earliest pending wakeup, MaxTick if there is none
+    Tick nextWakeupTime() const;
+    void processWakeup();
 
     class ConsumerEvent : public Event
     {
       public:
           ConsumerEvent(Consumer* _consumer)
-              : Event(Default_Pri, AutoDelete), m_consumer_ptr(_consumer)
+              : Event(Default_Pri), m_consumer_ptr(_consumer)
           {
           }
 
-          void process()
-          {
-              m_consumer_ptr->wakeup();
-              m_consumer_ptr->removeScheduledWakeupTime(when());
-          }
+          void process() { m_consumer_ptr->processWakeup(); }
+          const char *description() const { return "Ruby consumer wakeup"; }
 
       private:
           Consumer* m_consumer_ptr;
     };
+
+    Tick m_last_scheduled_wakeup;
+
+    // Pending wakeups.  Consumers are woken at most a few cycles ahead,
+    // so bit i of m_wakeup_mask stands for m_mask_base + i *
+    // m_mask_period and bit 0 is set whenever the mask is not empty.
+    // Times that do not land on the mask go to m_far_wakeups, kept in
+    // order.  Neither allocates once the vector has grown to fit.
+    uint64_t m_wakeup_mask;
+    Tick m_mask_base;
+    Tick m_mask_period;
+    std::vector<Tick> m_far_wakeups;
+
+    // true while wakeup() runs, processWakeup() then schedules the event
+    bool m_waking;
+    ClockedObject *em;
+    // Always scheduled at the earliest pending wakeup
+    ConsumerEvent m_wakeup_event;
+
+    static uint64_t s_num_wakeups;
 };
 
 inline std::ostream&
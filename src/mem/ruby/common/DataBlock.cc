@@ -26,21 +26,104 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "mem/ruby/common/DataBlock.hh"
 #include "mem/ruby/system/System.hh"
 
+namespace {
+
+// Whole lines are compared and copied with their size known at compile
+// time for the usual block sizes, so that both turn into a few vector
+// loads and stores instead of a library call.
+
+template <int Size>
+inline bool
+lineEqual(const uint8_t *a, const uint8_t *b)
+{
+#if defined(__SSE2__)
+    __m128i diff = _mm_setzero_si128();
+    for (int i = 0; i < Size; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        diff = _mm_or_si128(diff, _mm_xor_si128(x, y));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) ==
+        0xffff;
+#else
+    uint64_t diff = 0;
+    for (int i = 0; i < Size; i += sizeof(uint64_t)) {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        diff |= x ^ y;
+    }
+    return diff == 0;
+#endif
+}
+
+inline bool
+lineEqual(const uint8_t *a, const uint8_t *b, int size)
+{
+    switch (size) {
+      case 32: return lineEqual<32>(a, b);
+      case 64: return lineEqual<64>(a, b);
+      case 128: return lineEqual<128>(a, b);
+      default: return !memcmp(a, b, size);
+    }
+}
+
+inline void
+lineCopy(uint8_t *dst, const uint8_t *src, int size)
+{
+    switch (size) {
+      case 32: memcpy(dst, src, 32); break;
+      case 64: memcpy(dst, src, 64); break;
+      case 128: memcpy(dst, src, 128); break;
+      default: memcpy(dst, src, size); break;
+    }
+}
+
+} // anonymous namespace
+
 DataBlock::DataBlock(const DataBlock &cp)
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+    allocStorage();
+    lineCopy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+}
+
+DataBlock::DataBlock(DataBlock &&cp)
+{
+    if (cp.onHeap()) {
+        m_data = cp.m_data;
+        m_alloc = true;
+        cp.m_data = NULL;
+        cp.m_alloc = false;
+    } else {
+        // Inline lines are as cheap to copy as to move, and a view has to
+        // keep aliasing its backing store
+        allocStorage();
+        lineCopy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+    }
+}
+
+void
+DataBlock::allocStorage()
+{
+    int size = RubySystem::getBlockSizeBytes();
+    m_data = size <= InlineBytes ? m_inline : new uint8_t[size];
     m_alloc = true;
 }
 
 void
 DataBlock::alloc()
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    m_alloc = true;
+    allocStorage();
     clear();
 }
 
@@ -53,7 +136,7 @@ DataBlock::clear()
 bool
 DataBlock::equal(const DataBlock& obj) const
 {
-    return !memcmp(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    return lineEqual(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
 }
 
 void
@@ -80,13 +163,34 @@ DataBlock::getData(int offset, int len) const
 void
 DataBlock::setData(uint8_t *data, int offset, int len)
 {
-    assert(offset + len <= RubySystem::getBlockSizeBytes());
-    memcpy(&m_data[offset], data, len);
+    int size = RubySystem::getBlockSizeBytes();
+    assert(offset + len <= size);
+    if (len == size) {
+        lineCopy(m_data, data, size);
+    } else {
+        memcpy(&m_data[offset], data, len);
+    }
 }
 
 DataBlock &
 DataBlock::operator=(const DataBlock & obj)
 {
-    memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    if (m_data == NULL) {
+        // moved from
+        allocStorage();
+    }
+    if (this != &obj)
+        lineCopy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
     return *this;
 }
+
+DataBlock &
+DataBlock::operator=(DataBlock && obj)
+{
+    if (onHeap() && obj.onHeap()) {
+        std::swap(m_data, obj.m_data);
+        return *this;
+    }
+    // A view writes through to its backing store, so the bytes are copied
+    return *this = static_cast<const DataBlock &>(obj);
+}
@@ -35,6 +35,8 @@
 #include <iomanip>
 #include <iostream>
 
+#include "base/compiler.hh"
+
 class DataBlock
 {
   public:
@@ -44,14 +46,18 @@ class DataBlock
     }
 
     DataBlock(const DataBlock &cp);
+    // Takes over a heap line, a moved-from block may only be assigned
+    // to or destroyed
+    DataBlock(DataBlock &&cp);
 
     ~DataBlock()
     {
-        if (m_alloc)
+        if (onHeap())
             delete [] m_data;
     }
 
     DataBlock& operator=(const DataBlock& obj);
+    DataBlock& operator=(DataBlock&& obj);
 
     void assign(uint8_t *data);
 
@@ -65,16 +71,26 @@ class DataBlock
     void print(std::ostream& out) const;
 
   private:
+    // Lines up to InlineBytes long are kept in the block itself, so that
+    // a message or an entry carrying one needs no allocation of its own
+    static const int InlineBytes = 64;
+
     void alloc();
+    // point m_data at storage of our own without initialising it
+    void allocStorage();
+    bool onHeap() const { return m_alloc && m_data != m_inline; }
+
     uint8_t *m_data;
     bool m_alloc;
+    // aligned so that whole line copies and compares are vector wide
+    uint8_t m_inline[InlineBytes] M5_ATTR_ALIGNED(16);
 };
 
 inline void
 DataBlock::assign(uint8_t *data)
 {
     assert(data != NULL);
-    if (m_alloc) {
+    if (onHeap()) {
         delete [] m_data;
     }
     m_data = data;
@@ -0,0 +1,277 @@
+#include <cstring>
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "mem/ruby/common/SharerSet.hh"
+
+using namespace std;
+
+int SharerSet::s_pointers = 0;
+int SharerSet::s_vector_bits = 0;
+int SharerSet::s_num_l1 = 0;
+int SharerSet::s_group_size = 1;
+int SharerSet::s_num_groups = 0;
+int SharerSet::s_num_words = 0;
+
+void
+SharerSet::configure(int pointers, int vector_bits, int num_l1)
+{
+    if (pointers < 0 || pointers > MaxPointers) {
+        fatal("sharer_pointers is %d, it must lie in [0, %d]\n",
+              pointers, MaxPointers);
+    }
+    if (vector_bits < 0 || vector_bits > MaxVectorBits) {
+        fatal("sharer_vector_bits is %d, it must lie in [0, %d]\n",
+              vector_bits, MaxVectorBits);
+    }
+    s_pointers = pointers;
+    s_vector_bits = vector_bits;
+    s_num_l1 = 0;
+    if (num_l1 > 0)
+        setup(num_l1);
+}
+
+void
+SharerSet::setup(int num_l1)
+{
+    assert(num_l1 > 0);
+    s_num_l1 = num_l1;
+
+    int groups = s_num_l1;
+    if (s_pointers > 0)
+        groups = min(max(s_vector_bits, 1), s_num_l1);
+    s_group_size = divCeil(s_num_l1, groups);
+    s_num_groups = divCeil(s_num_l1, s_group_size);
+    s_num_words = divCeil(s_num_groups, 64);
+}
+
+SharerSet::SharerSet()
+    : m_num_pointers(0), m_overflow(false), m_wide(NULL)
+{
+    memset(m_bits, 0, sizeof(m_bits));
+}
+
+SharerSet::SharerSet(const SharerSet& other)
+    : m_num_pointers(other.m_num_pointers), m_overflow(other.m_overflow),
+      m_wide(NULL)
+{
+    memcpy(m_bits, other.m_bits, sizeof(m_bits));
+    if (other.m_wide != NULL) {
+        m_wide = new uint64_t[s_num_words];
+        memcpy(m_wide, other.m_wide, s_num_words * sizeof(uint64_t));
+    }
+}
+
+SharerSet::~SharerSet()
+{
+    delete [] m_wide;
+}
+
+SharerSet&
+SharerSet::operator=(const SharerSet& other)
+{
+    if (this == &other)
+        return *this;
+
+    m_num_pointers = other.m_num_pointers;
+    m_overflow = other.m_overflow;
+    memcpy(m_bits, other.m_bits, sizeof(m_bits));
+    if (other.m_wide != NULL) {
+        if (m_wide == NULL)
+            m_wide = new uint64_t[s_num_words];
+        memcpy(m_wide, other.m_wide, s_num_words * sizeof(uint64_t));
+    } else if (m_wide != NULL) {
+        memset(m_wide, 0, s_num_words * sizeof(uint64_t));
+    }
+    return *this;
+}
+
+int
+SharerSet::numWords() const
+{
+    return m_wide != NULL ? s_num_words : min(s_num_words, (int)InlineWords);
+}
+
+void
+SharerSet::setGroup(int group)
+{
+    int word = group / 64;
+    if (word >= InlineWords && m_wide == NULL) {
+        // Only a full map of many L1s gets here
+        m_wide = new uint64_t[s_num_words];
+        memset(m_wide, 0, s_num_words * sizeof(uint64_t));
+        memcpy(m_wide, m_bits, sizeof(m_bits));
+    }
+    words()[word] |= ULL(1) << (group % 64);
+}
+
+bool
+SharerSet::hasGroup(int group) const
+{
+    int word = group / 64;
+    if (word >= numWords())
+        return false;
+    return (words()[word] >> (group % 64)) & 1;
+}
+
+int
+SharerSet::groupSize(int group) const
+{
+    return min(s_group_size, s_num_l1 - group * s_group_size);
+}
+
+bool
+SharerSet::add(MachineID sharer)
+{
+    assert(sharer.type == MachineType_L1Cache);
+    if (s_num_l1 == 0)
+        setup(MachineType_base_count(MachineType_L1Cache));
+    assert(sharer.num < s_num_l1);
+
+    if (inVector()) {
+        setGroup(groupOf(sharer.num));
+        return false;
+    }
+
+    for (int i = 0; i < m_num_pointers; i++) {
+        if (m_pointers[i] == sharer.num)
+            return false;
+    }
+    if (m_num_pointers < s_pointers) {
+        m_pointers[m_num_pointers++] = sharer.num;
+        return false;
+    }
+
+    // Out of pointers, fold them into the vector
+    uint16_t pointers[MaxPointers];
+    memcpy(pointers, m_pointers, sizeof(pointers));
+    memset(m_bits, 0, sizeof(m_bits));
+    for (int i = 0; i < m_num_pointers; i++)
+        setGroup(groupOf(pointers[i]));
+    setGroup(groupOf(sharer.num));
+    m_num_pointers = 0;
+    m_overflow = true;
+    return true;
+}
+
+void
+SharerSet::remove(MachineID sharer)
+{
+    assert(sharer.type == MachineType_L1Cache);
+
+    if (inVector()) {
+        // A group bit may stand for other sharers as well
+        if (s_group_size == 1 && hasGroup(sharer.num))
+            words()[sharer.num / 64] &= ~(ULL(1) << (sharer.num % 64));
+        return;
+    }
+
+    for (int i = 0; i < m_num_pointers; i++) {
+        if (m_pointers[i] == sharer.num) {
+            m_pointers[i] = m_pointers[--m_num_pointers];
+            return;
+        }
+    }
+}
+
+void
+SharerSet::clear()
+{
+    m_num_pointers = 0;
+    m_overflow = false;
+    memset(m_bits, 0, sizeof(m_bits));
+    if (m_wide != NULL)
+        memset(m_wide, 0, s_num_words * sizeof(uint64_t));
+}
+
+bool
+SharerSet::isElement(MachineID sharer) const
+{
+    if (sharer.type != MachineType_L1Cache)
+        return false;
+
+    if (inVector())
+        return s_num_l1 > 0 && hasGroup(groupOf(sharer.num));
+
+    for (int i = 0; i < m_num_pointers; i++) {
+        if (m_pointers[i] == sharer.num)
+            return true;
+    }
+    return false;
+}
+
+bool
+SharerSet::isEmpty() const
+{
+    if (!inVector())
+        return m_num_pointers == 0;
+
+    const uint64_t *bits = words();
+    for (int i = 0; i < numWords(); i++) {
+        if (bits[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+int
+SharerSet::count() const
+{
+    if (!inVector())
+        return m_num_pointers;
+
+    const uint64_t *bits = words();
+    int n = 0;
+    for (int i = 0; i < numWords(); i++) {
+        for (uint64_t w = bits[i]; w != 0; w &= w - 1)
+            n += groupSize(i * 64 + findLsbSet(w));
+    }
+    return n;
+}
+
+NetDest
+SharerSet::getDestination() const
+{
+    NetDest dest;
+    MachineID mach = {MachineType_L1Cache, 0};
+
+    if (!inVector()) {
+        for (int i = 0; i < m_num_pointers; i++) {
+            mach.num = m_pointers[i];
+            dest.add(mach);
+        }
+        return dest;
+    }
+
+    const uint64_t *bits = words();
+    for (int i = 0; i < numWords(); i++) {
+        for (uint64_t w = bits[i]; w != 0; w &= w - 1) {
+            int group = i * 64 + findLsbSet(w);
+            int first = group * s_group_size;
+            for (int j = 0; j < groupSize(group); j++) {
+                mach.num = first + j;
+                dest.add(mach);
+            }
+        }
+    }
+    return dest;
+}
+
+void
+SharerSet::print(ostream& out) const
+{
+    out << "[SharerSet ";
+    if (isImprecise())
+        out << "groups of " << s_group_size << ": ";
+    if (!inVector()) {
+        for (int i = 0; i < m_num_pointers; i++)
+            out << m_pointers[i] << " ";
+    } else {
+        for (int g = 0; g < s_num_groups; g++) {
+            if (hasGroup(g))
+                out << g << " ";
+        }
+    }
+    out << "]";
+}
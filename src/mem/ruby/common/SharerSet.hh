@@ -0,0 +1,109 @@
+// SharerSet records which L1 caches may hold a copy of a line.  Unlike a
+// NetDest, which keeps a bit for every component of every machine type,
+// it takes a fixed amount of space however many cores there are.
+//
+// The representation is chosen for the whole system by RubySystem:
+//
+//  - full map (sharer_pointers = 0): one bit per L1, always exact.
+//  - limited pointers (sharer_pointers = i): up to i L1 ids are kept
+//    exactly.  Adding one more overflows the set, which from then on
+//    holds a coarse vector of sharer_vector_bits bits, each standing for
+//    a group of consecutive L1s.  With sharer_vector_bits = 0 the vector
+//    is a single bit and an overflowed set stands for every L1.
+//
+// Once a coarse set is imprecise, invalidations go to every L1 of every
+// group whose bit is set, and removing a single sharer has no effect
+// until the set is cleared.  count() and isElement() describe that
+// destination rather than the true sharers, so ack counts derived from
+// them stay consistent with the invalidations actually sent.
+
+#ifndef __MEM_RUBY_COMMON_SHARERSET_HH__
+#define __MEM_RUBY_COMMON_SHARERSET_HH__
+
+#include <iostream>
+
+#include "base/types.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/system/MachineID.hh"
+
+class SharerSet
+{
+  public:
+    //! Most pointers a limited pointer set may hold
+    static const int MaxPointers = 16;
+    //! Words of vector kept inside the set, bounding sharer_vector_bits
+    static const int InlineWords = 4;
+    static const int MaxVectorBits = InlineWords * 64;
+
+    // Called once by RubySystem before any set is used.  With num_l1 = 0
+    // the number of L1s is taken from the L1 controllers on first use.
+    static void configure(int pointers, int vector_bits, int num_l1 = 0);
+
+    SharerSet();
+    SharerSet(const SharerSet& other);
+    ~SharerSet();
+
+    SharerSet& operator=(const SharerSet& other);
+
+    // Returns true if this addition overflowed the pointers
+    bool add(MachineID sharer);
+    void remove(MachineID sharer);
+    void clear();
+
+    // True if sharer is among the L1s getDestination() returns
+    bool isElement(MachineID sharer) const;
+    bool isEmpty() const;
+    // L1s getDestination() returns
+    int count() const;
+    // True if the set may name L1s that are not sharers
+    bool isImprecise() const
+    { return inVector() && s_group_size > 1; }
+
+    // The L1s an invalidation of the line has to reach
+    NetDest getDestination() const;
+
+    void print(std::ostream& out) const;
+
+  private:
+    bool inVector() const { return m_overflow || s_pointers == 0; }
+    int groupOf(NodeID sharer) const { return sharer / s_group_size; }
+    // Words of the vector this set can hold right now
+    int numWords() const;
+    uint64_t *words() { return m_wide != NULL ? m_wide : m_bits; }
+    const uint64_t *words() const
+    { return m_wide != NULL ? m_wide : m_bits; }
+    void setGroup(int group);
+    bool hasGroup(int group) const;
+    // L1s covered by one group, the last group may be short
+    int groupSize(int group) const;
+
+    // Work out the vector layout once the L1s are known
+    static void setup(int num_l1);
+
+    uint16_t m_num_pointers;
+    bool m_overflow;
+    union
+    {
+        uint16_t m_pointers[MaxPointers];
+        uint64_t m_bits[InlineWords];
+    };
+    // A full map for more than MaxVectorBits L1s, NULL until needed
+    uint64_t *m_wide;
+
+    static int s_pointers;
+    static int s_vector_bits;
+    static int s_num_l1;
+    static int s_group_size;
+    static int s_num_groups;
+    static int s_num_words;
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const SharerSet& obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_COMMON_SHARERSET_HH__
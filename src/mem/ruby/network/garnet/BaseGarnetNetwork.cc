@@ -29,6 +29,7 @@
  */
 
 #include "mem/ruby/buffers/MessageBuffer.hh"
+#include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/BasicLink.hh"
 #include "mem/ruby/network/Topology.hh"
 #include "mem/ruby/network/garnet/BaseGarnetNetwork.hh"
@@ -164,4 +165,10 @@ BaseGarnetNetwork::regStats()
 
     m_avg_latency.name(name() + ".average_latency");
     m_avg_latency = m_avg_network_latency + m_avg_queueing_latency;
+
+    m_consumer_wakeups
+        .functor(Consumer::numWakeups)
+        .name(name() + ".consumer_wakeups")
+        .desc("wakeups processed by all ruby consumers")
+        ;
 }
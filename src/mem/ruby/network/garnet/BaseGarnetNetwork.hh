@@ -105,6 +105,9 @@ class BaseGarnetNetwork : public Network
     Stats::Formula m_avg_network_latency;
     Stats::Formula m_avg_queueing_latency;
     Stats::Formula m_avg_latency;
+
+    //! Wakeups processed by all Ruby consumers, routers and links included
+    Stats::Value m_consumer_wakeups;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_BASEGARNETNETWORK_HH__
@@ -0,0 +1,85 @@
+#ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_BITSET_D_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_BITSET_D_HH__
+
+#include <cassert>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "base/types.hh"
+
+// A set of small integers, used by the router to walk its busy ports and
+// virtual channels without visiting the idle ones
+class BitSet_d
+{
+  public:
+    BitSet_d() : m_size(0), m_count(0) {}
+
+    void
+    resize(int size)
+    {
+        m_size = size;
+        m_words.assign((size + 63) / 64, 0);
+        m_count = 0;
+    }
+
+    bool
+    test(int i) const
+    {
+        assert(i >= 0 && i < m_size);
+        return (m_words[i / 64] >> (i % 64)) & 1;
+    }
+
+    // Returns true if i was not in the set
+    bool
+    set(int i)
+    {
+        if (test(i))
+            return false;
+        m_words[i / 64] |= ULL(1) << (i % 64);
+        m_count++;
+        return true;
+    }
+
+    // Returns true if i was in the set
+    bool
+    clear(int i)
+    {
+        if (!test(i))
+            return false;
+        m_words[i / 64] &= ~(ULL(1) << (i % 64));
+        m_count--;
+        return true;
+    }
+
+    bool empty() const { return m_count == 0; }
+    int count() const { return m_count; }
+
+    // Smallest member no less than i, -1 if there is none
+    int
+    next(int i) const
+    {
+        for (int w = i / 64; w < (int)m_words.size(); w++) {
+            uint64_t bits = m_words[w];
+            if (w == i / 64)
+                bits &= ~ULL(0) << (i % 64);
+            if (bits != 0)
+                return w * 64 + findLsbSet(bits);
+        }
+        return -1;
+    }
+
+    // Like next(), but wraps round to the smallest member
+    int
+    nextWrap(int i) const
+    {
+        int n = next(i);
+        return n != -1 ? n : next(0);
+    }
+
+  private:
+    int m_size;
+    int m_count;
+    std::vector<uint64_t> m_words;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_BITSET_D_HH__
@@ -52,6 +52,8 @@ GarnetNetwork_d::GarnetNetwork_d(const Params *p)
 {
     m_buffers_per_data_vc = p->buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p->buffers_per_ctrl_vc;
+    m_routing_algorithm = p->routing_algorithm;
+    m_mesh_rows = p->mesh_rows;
 
     m_vnet_type.resize(m_virtual_networks);
     for (int i = 0; i < m_vnet_type.size(); i++) {
@@ -90,6 +92,12 @@ GarnetNetwork_d::init()
     }
     m_topology_ptr->createLinks(this);
 
+    // every route is known now, turn them into lookup tables
+    for (vector<Router_d*>::const_iterator i = m_routers.begin();
+         i != m_routers.end(); ++i) {
+        (*i)->buildRoutingTable();
+    }
+
     // initialize the link's network pointers
    for (vector<NetworkLink_d*>::const_iterator i = m_links.begin();
          i != m_links.end(); ++i) {
@@ -176,7 +184,7 @@ GarnetNetwork_d::makeOutLink(SwitchID src, NodeID dest, BasicLink* link,
     m_creditlinks.push_back(credit_link);
 
     m_routers[src]->addOutPort(net_link, routing_table_entry,
-                                         link->m_weight, credit_link);
+                               link->m_weight, credit_link, -1);
     m_nis[dest]->addInPort(net_link, credit_link);
 }
 
@@ -198,7 +206,7 @@ GarnetNetwork_d::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
 
     m_routers[dest]->addInPort(net_link, credit_link);
     m_routers[src]->addOutPort(net_link, routing_table_entry,
-                                         link->m_weight, credit_link);
+                               link->m_weight, credit_link, dest);
 }
 
 void
@@ -225,6 +233,7 @@ GarnetNetwork_d::regStats()
 {
     BaseGarnetNetwork::regStats();
     regLinkStats();
+    regHopStats();
     regPowerStats();
 }
 
@@ -240,6 +249,36 @@ GarnetNetwork_d::regLinkStats()
         ;
 }
 
+void
+GarnetNetwork_d::regHopStats()
+{
+    m_bypassed_hops
+        .init(m_virtual_networks)
+        .name(name() + ".bypassed_hops")
+        .desc("router hops taken without buffering the flit")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+
+    m_buffered_hops
+        .init(m_virtual_networks)
+        .name(name() + ".buffered_hops")
+        .desc("router hops taken through the input buffers")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_bypassed_hops.subname(i, csprintf("vnet-%i", i));
+        m_buffered_hops.subname(i, csprintf("vnet-%i", i));
+    }
+
+    m_bypass_fraction
+        .name(name() + ".bypass_fraction")
+        .desc("fraction of router hops that bypassed the buffers")
+        ;
+    m_bypass_fraction = sum(m_bypassed_hops) /
+        (sum(m_bypassed_hops) + sum(m_buffered_hops));
+}
+
 void
 GarnetNetwork_d::regPowerStats()
 {
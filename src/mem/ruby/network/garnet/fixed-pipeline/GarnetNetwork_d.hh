@@ -34,6 +34,7 @@
 #include <iostream>
 #include <vector>
 
+#include "enums/GarnetRouting.hh"
 #include "mem/ruby/network/garnet/BaseGarnetNetwork.hh"
 #include "mem/ruby/network/garnet/NetworkHeader.hh"
 #include "mem/ruby/network/Network.hh"
@@ -62,6 +63,13 @@ class GarnetNetwork_d : public BaseGarnetNetwork
 
     int getBuffersPerDataVC() {return m_buffers_per_data_vc; }
     int getBuffersPerCtrlVC() {return m_buffers_per_ctrl_vc; }
+    int getNumRouters() { return m_routers.size(); }
+    Enums::GarnetRouting getRoutingAlgorithm() { return m_routing_algorithm; }
+    int getMeshRows() { return m_mesh_rows; }
+
+    // Routers a flit crossed without, or after, being buffered
+    void increment_bypassed_hops(int vnet) { m_bypassed_hops[vnet]++; }
+    void increment_buffered_hops(int vnet) { m_buffered_hops[vnet]++; }
 
     void collateStats();
     void regStats();
@@ -99,6 +107,7 @@ class GarnetNetwork_d : public BaseGarnetNetwork
     void collateLinkStats();
     void collatePowerStats();
     void regLinkStats();
+    void regHopStats();
     void regPowerStats();
 
     std::vector<VNET_type > m_vnet_type;
@@ -110,6 +119,8 @@ class GarnetNetwork_d : public BaseGarnetNetwork
 
     int m_buffers_per_data_vc;
     int m_buffers_per_ctrl_vc;
+    Enums::GarnetRouting m_routing_algorithm;
+    int m_mesh_rows;
 
     // Statistical variables for power
     Stats::Scalar m_dynamic_link_power;
@@ -124,6 +135,10 @@ class GarnetNetwork_d : public BaseGarnetNetwork
     // Statistical variables for performance
     Stats::Scalar m_average_link_utilization;
     Stats::Vector m_average_vc_load;
+
+    Stats::Vector m_bypassed_hops;
+    Stats::Vector m_buffered_hops;
+    Stats::Formula m_bypass_fraction;
 };
 
 inline std::ostream&
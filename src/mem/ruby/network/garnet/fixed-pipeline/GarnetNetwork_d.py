@@ -31,8 +31,19 @@
 from m5.params import *
 from BaseGarnetNetwork import BaseGarnetNetwork
 
+# table follows the topology's link weights, the others need a mesh
+class GarnetRouting(Enum): vals = ['table', 'xy', 'yx', 'west_first',
+                                   'minimal_adaptive']
+
 class GarnetNetwork_d(BaseGarnetNetwork):
     type = 'GarnetNetwork_d'
     cxx_header = "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
     buffers_per_data_vc = Param.Int(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.Int(1, "buffers per ctrl virtual channel");
+    routing_algorithm = Param.GarnetRouting('table',
+        "how routers pick among the output ports on a shortest path; "
+        "minimal_adaptive is not deadlock free")
+    mesh_rows = Param.Int(0, "rows of the mesh the routers form, router ids "
+        "in row major order; needed by every routing algorithm but table")
+    max_bypass_hops = Param.Int(0, "routers a flit may cross in one link "
+        "latency without being buffered, 0 disables bypassing")
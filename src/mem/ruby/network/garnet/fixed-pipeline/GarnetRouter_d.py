@@ -40,5 +40,8 @@ class GarnetRouter_d(BasicRouter):
                               "virtual channels per virtual network")
     virt_nets = Param.Int(Parent.number_of_virtual_networks,
                           "number of virtual networks")
+    max_bypass_hops = Param.Int(Parent.max_bypass_hops,
+        "routers a flit may cross in one link latency without being "
+        "buffered")
 
 
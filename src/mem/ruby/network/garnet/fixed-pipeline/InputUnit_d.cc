@@ -29,7 +29,9 @@
  */
 
 #include "base/stl_helpers.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/InputUnit_d.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/OutputUnit_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/Router_d.hh"
 
 using namespace std;
@@ -55,6 +57,7 @@ InputUnit_d::InputUnit_d(int id, Router_d *router) : Consumer(router)
     for (int i=0; i < m_num_vcs; i++) {
         m_vcs[i] = new VirtualChannel_d(i);
     }
+    m_active_vcs.resize(m_num_vcs);
 }
 
 InputUnit_d::~InputUnit_d()
@@ -71,11 +74,20 @@ InputUnit_d::wakeup()
 
         t_flit = m_in_link->consumeLink();
         int vc = t_flit->get_vc();
+        int vnet = vc/m_vc_per_vnet;
+
+        if (try_bypass(t_flit, vc)) {
+            m_router->get_net_ptr()->increment_bypassed_hops(vnet);
+            return;
+        }
+        t_flit->set_bypass_hops(0);
+        m_router->get_net_ptr()->increment_buffered_hops(vnet);
 
         if ((t_flit->get_type() == HEAD_) ||
            (t_flit->get_type() == HEAD_TAIL_)) {
 
             assert(m_vcs[vc]->get_state() == IDLE_);
+            set_vc_active(vc);
             // Do the route computation for this vc
             m_router->route_req(t_flit, this, vc);
 
@@ -87,7 +99,6 @@ InputUnit_d::wakeup()
         // write flit into input buffer
         m_vcs[vc]->insertFlit(t_flit);
 
-        int vnet = vc/m_vc_per_vnet;
         // number of writes same as reads
         // any flit that is written will be read only once
         m_num_buffer_writes[vnet]++;
@@ -95,6 +106,83 @@ InputUnit_d::wakeup()
     }
 }
 
+// A flit bypasses the router when it is next in line for its vc and
+// output port and a downstream vc has room for it.  It then takes the
+// output link in the cycle it arrived, so up to max_bypass_hops routers
+// are crossed in one segment that pays the link latency once.  The
+// crossbar is still traversed.  The vc and credit state is updated as
+// if the flit had gone through the pipeline, so flits of the same packet
+// that cannot bypass follow it through the buffers.
+bool
+InputUnit_d::try_bypass(flit_d *t_flit, int vc)
+{
+    if (t_flit->get_bypass_hops() >= m_router->get_max_bypass_hops() ||
+        !m_vcs[vc]->isEmpty())
+        return false;
+
+    Cycles curTime = m_router->curCycle();
+    flit_type type = t_flit->get_type();
+    bool head = type == HEAD_ || type == HEAD_TAIL_;
+    int outport, outvc;
+    if (head) {
+        assert(m_vcs[vc]->get_state() == IDLE_);
+        outport = m_router->route_compute(t_flit);
+        outvc = m_router->get_outputUnit_ref()[outport]->
+            select_bypass_vc(t_flit->get_vnet());
+        if (outvc == -1)
+            return false;
+    } else {
+        // the head is still waiting for an output vc
+        if (m_vcs[vc]->get_state() != ACTIVE_)
+            return false;
+        outport = m_vcs[vc]->get_route();
+        outvc = m_vcs[vc]->get_outvc();
+    }
+
+    OutputUnit_d *output_unit = m_router->get_outputUnit_ref()[outport];
+    if (output_unit->get_credit_cnt(outvc) == 0 ||
+        !m_router->can_bypass(m_id, vc, outport))
+        return false;
+
+    if (head) {
+        set_vc_active(vc);
+        m_vcs[vc]->set_outport(outport);
+        m_vcs[vc]->set_outvc(outvc);
+        m_vcs[vc]->set_state(ACTIVE_, curTime);
+        m_vcs[vc]->set_enqueue_time(curTime);
+        output_unit->update_vc(outvc, m_id, vc);
+    }
+    output_unit->decrement_credit(outvc);
+
+    bool tail = type == TAIL_ || type == HEAD_TAIL_;
+    increment_credit(vc, tail, curTime);
+    if (tail) {
+        set_vc_state(IDLE_, vc, curTime);
+        set_enqueue_time(vc, Cycles(INFINITE_));
+    }
+
+    t_flit->set_vc(outvc);
+    t_flit->set_outport(outport);
+    t_flit->set_bypass_hops(t_flit->get_bypass_hops() + 1);
+    m_router->update_sw_bypass();
+    output_unit->bypass_flit(t_flit);
+    return true;
+}
+
+void
+InputUnit_d::set_vc_active(int vc)
+{
+    if (m_active_vcs.set(vc) && m_active_vcs.count() == 1)
+        m_router->set_inport_active(m_id, true);
+}
+
+void
+InputUnit_d::set_vc_idle(int vc)
+{
+    if (m_active_vcs.clear(vc) && m_active_vcs.empty())
+        m_router->set_inport_active(m_id, false);
+}
+
 uint32_t
 InputUnit_d::functionalWrite(Packet *pkt)
 {
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/BitSet_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/CreditLink_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/NetworkLink_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/VirtualChannel_d.hh"
@@ -59,8 +60,13 @@ class InputUnit_d : public Consumer
     set_vc_state(VC_state_type state, int vc, Cycles curTime)
     {
         m_vcs[vc]->set_state(state, curTime);
+        if (state == IDLE_)
+            set_vc_idle(vc);
     }
 
+    // VCs holding a packet, from its head arriving to its tail leaving
+    const BitSet_d& get_active_vcs() const { return m_active_vcs; }
+
     inline void
     set_enqueue_time(int invc, Cycles time)
     {
@@ -169,6 +175,12 @@ class InputUnit_d : public Consumer
     uint32_t functionalWrite(Packet *pkt);
 
   private:
+    void set_vc_active(int vc);
+    void set_vc_idle(int vc);
+    // Send the flit straight on if it can cross the router this cycle
+    // without being buffered
+    bool try_bypass(flit_d *t_flit, int vc);
+
     int m_id;
     int m_num_vcs;
     int m_vc_per_vnet;
@@ -180,6 +192,7 @@ class InputUnit_d : public Consumer
 
     // Virtual channels
     std::vector<VirtualChannel_d *> m_vcs;
+    BitSet_d m_active_vcs;
 
     // Statistical variables
     std::vector<double> m_num_buffer_writes;
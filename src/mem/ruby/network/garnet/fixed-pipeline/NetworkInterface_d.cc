@@ -173,6 +173,7 @@ NetworkInterface_d::flitisizeMessage(MsgPtr msg_ptr, int vnet)
             m_net_ptr->increment_injected_flits(vnet);
             flit_d *fl = new flit_d(i, vc, vnet, num_flits, new_msg_ptr,
                 m_net_ptr->curCycle());
+            fl->set_dest(destID);
 
             fl->set_delay(m_net_ptr->curCycle() -
                           m_net_ptr->ticksToCycles(msg_ptr->getTime()));
@@ -76,6 +76,19 @@ NetworkLink_d::wakeup()
     }
 }
 
+void
+NetworkLink_d::bypass(flit_d *t_flit)
+{
+    // The link latency is paid once per bypass segment, on its first
+    // link; the links after it are crossed in the same cycle
+    Cycles latency = t_flit->get_bypass_hops() == 1 ? m_latency : Cycles(0);
+    t_flit->set_time(curCycle() + latency);
+    linkBuffer->insert(t_flit);
+    link_consumer->scheduleEventAbsolute(clockEdge(latency));
+    m_link_utilized++;
+    m_vc_load[t_flit->get_vc()]++;
+}
+
 NetworkLink_d *
 NetworkLink_dParams::create()
 {
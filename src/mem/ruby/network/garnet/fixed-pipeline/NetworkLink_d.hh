@@ -65,6 +65,11 @@ class NetworkLink_d : public ClockedObject, public Consumer
 
     inline bool isReady(Cycles curTime)
     { return linkBuffer->isReady(curTime); }
+    // true if no flit is on its way across the link
+    inline bool isEmpty() { return linkBuffer->isEmpty(); }
+
+    // Send a flit that bypassed the upstream router across the link
+    void bypass(flit_d *t_flit);
 
     inline flit_d* peekLink()       { return linkBuffer->peekTopFlit(); }
     inline flit_d* consumeLink()    { return linkBuffer->getTopFlit(); }
@@ -74,13 +74,31 @@ OutputUnit_d::wakeup()
                                   m_outvc_state[out_vc]->get_invc(),
                                   m_outvc_state[out_vc]->get_credit_count());
 
-        if (t_flit->is_free_signal())
+        // The allocators do not poll blocked vcs, so let them know that
+        // a vc or a credit is available again
+        if (t_flit->is_free_signal()) {
             set_vc_state(IDLE_, out_vc, m_router->curCycle());
+            m_router->vcarb_req();
+        } else {
+            m_router->swarb_req();
+        }
 
         delete t_flit;
     }
 }
 
+int
+OutputUnit_d::select_bypass_vc(int vnet)
+{
+    int vc_per_vnet = m_router->get_vc_per_vnet();
+    for (int vc = vnet * vc_per_vnet; vc < (vnet + 1) * vc_per_vnet; vc++) {
+        if (is_vc_idle(vc, m_router->curCycle()) &&
+            m_outvc_state[vc]->has_credits())
+            return vc;
+    }
+    return -1;
+}
+
 flitBuffer_d*
 OutputUnit_d::getOutQueue()
 {
@@ -87,6 +87,22 @@ class OutputUnit_d : public Consumer
         m_out_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
     }
 
+    // true if no flit is waiting for or crossing the output link
+    inline bool
+    is_link_free()
+    {
+        return m_out_buffer->isEmpty() && m_out_link->isEmpty();
+    }
+
+    // An idle vc of vnet with credits to spare, -1 if there is none
+    int select_bypass_vc(int vnet);
+
+    inline void
+    bypass_flit(flit_d *t_flit)
+    {
+        m_out_link->bypass(t_flit);
+    }
+
     uint32_t functionalWrite(Packet *pkt);
 
   private:
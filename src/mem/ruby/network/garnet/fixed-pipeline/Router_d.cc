@@ -49,6 +49,7 @@ Router_d::Router_d(const Params *p)
     m_virtual_networks = p->virt_nets;
     m_vc_per_vnet = p->vcs_per_vnet;
     m_num_vcs = m_virtual_networks * m_vc_per_vnet;
+    m_max_bypass_hops = p->max_bypass_hops;
 
     m_routing_unit = new RoutingUnit_d(this);
     m_vc_alloc = new VCallocator_d(this);
@@ -88,6 +89,7 @@ Router_d::init()
 {
     BasicRouter::init();
 
+    m_active_inports.resize(m_input_unit.size());
     m_vc_alloc->init();
     m_sw_alloc->init();
     m_switch->init();
@@ -110,7 +112,7 @@ Router_d::addInPort(NetworkLink_d *in_link, CreditLink_d *credit_link)
 void
 Router_d::addOutPort(NetworkLink_d *out_link,
     const NetDest& routing_table_entry, int link_weight,
-    CreditLink_d *credit_link)
+    CreditLink_d *credit_link, int neighbour)
 {
     int port_num = m_output_unit.size();
     OutputUnit_d *output_unit = new OutputUnit_d(port_num, this);
@@ -122,16 +124,50 @@ Router_d::addOutPort(NetworkLink_d *out_link,
 
     m_output_unit.push_back(output_unit);
 
-    m_routing_unit->addRoute(routing_table_entry);
+    m_routing_unit->addRoute(routing_table_entry, neighbour);
     m_routing_unit->addWeight(link_weight);
 }
 
+void
+Router_d::buildRoutingTable()
+{
+    m_routing_unit->buildTable();
+}
+
 void
 Router_d::route_req(flit_d *t_flit, InputUnit_d *in_unit, int invc)
 {
     m_routing_unit->RC_stage(t_flit, in_unit, invc);
 }
 
+int
+Router_d::route_compute(flit_d *t_flit)
+{
+    return m_routing_unit->routeCompute(t_flit);
+}
+
+bool
+Router_d::can_bypass(int inport, int invc, int outport)
+{
+    // A flit ahead in the switch or on the link would be overtaken
+    if (m_switch->has_flit_for(outport) ||
+        !m_output_unit[outport]->is_link_free())
+        return false;
+
+    // Packets buffered here for the same output port go first
+    for (int i = m_active_inports.next(0); i != -1;
+         i = m_active_inports.next(i + 1)) {
+        const BitSet_d &active_vcs = m_input_unit[i]->get_active_vcs();
+        for (int vc = active_vcs.next(0); vc != -1;
+             vc = active_vcs.next(vc + 1)) {
+            if ((i != inport || vc != invc) &&
+                m_input_unit[i]->get_route(vc) == outport)
+                return false;
+        }
+    }
+    return true;
+}
+
 void
 Router_d::vcarb_req()
 {
@@ -144,6 +180,15 @@ Router_d::swarb_req()
     m_sw_alloc->scheduleEventAbsolute(clockEdge(Cycles(1)));
 }
 
+void
+Router_d::set_inport_active(int inport, bool active)
+{
+    if (active)
+        m_active_inports.set(inport);
+    else
+        m_active_inports.clear(inport);
+}
+
 void
 Router_d::update_incredit(int in_port, int in_vc, int credit)
 {
@@ -157,6 +202,12 @@ Router_d::update_sw_winner(int inport, flit_d *t_flit)
     m_switch->scheduleEventAbsolute(clockEdge(Cycles(1)));
 }
 
+void
+Router_d::update_sw_bypass()
+{
+    m_switch->increment_crossbar_activity();
+}
+
 void
 Router_d::calculate_performance_numbers()
 {
@@ -36,6 +36,7 @@
 
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/BasicRouter.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/BitSet_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/flit_d.hh"
 #include "mem/ruby/network/garnet/NetworkHeader.hh"
 #include "mem/ruby/network/orion/NetworkPower.hh"
@@ -62,8 +63,12 @@ class Router_d : public BasicRouter
 
     void init();
     void addInPort(NetworkLink_d *link, CreditLink_d *credit_link);
+    // neighbour is the router the port leads to, -1 for an NI
     void addOutPort(NetworkLink_d *link, const NetDest& routing_table_entry,
-                    int link_weight, CreditLink_d *credit_link);
+                    int link_weight, CreditLink_d *credit_link,
+                    int neighbour);
+    // Called once every port has been added
+    void buildRoutingTable();
 
     int get_num_vcs()       { return m_num_vcs; }
     int get_num_vnets()     { return m_virtual_networks; }
@@ -71,6 +76,7 @@ class Router_d : public BasicRouter
     int get_num_inports()   { return m_input_unit.size(); }
     int get_num_outports()  { return m_output_unit.size(); }
     int get_id()            { return m_id; }
+    int get_max_bypass_hops() { return m_max_bypass_hops; }
 
     void init_net_ptr(GarnetNetwork_d* net_ptr) 
     { 
@@ -81,9 +87,19 @@ class Router_d : public BasicRouter
     std::vector<InputUnit_d *>& get_inputUnit_ref()   { return m_input_unit; }
     std::vector<OutputUnit_d *>& get_outputUnit_ref() { return m_output_unit; }
 
+    // Input ports with a VC holding a packet; the allocators visit
+    // these only
+    const BitSet_d& get_active_inports() const { return m_active_inports; }
+    void set_inport_active(int inport, bool active);
+
     void update_sw_winner(int inport, flit_d *t_flit);
+    void update_sw_bypass();
     void update_incredit(int in_port, int in_vc, int credit);
     void route_req(flit_d *t_flit, InputUnit_d* in_unit, int invc);
+    int route_compute(flit_d *t_flit);
+    // true if a flit of invc at inport may skip the pipeline and go
+    // straight out of outport this cycle
+    bool can_bypass(int inport, int invc, int outport);
     void vcarb_req();
     void swarb_req();
     void printFaultVector(std::ostream& out);
@@ -109,12 +125,14 @@ class Router_d : public BasicRouter
 
   private:
     int m_virtual_networks, m_num_vcs, m_vc_per_vnet;
+    int m_max_bypass_hops;
     GarnetNetwork_d *m_network_ptr;
     double sw_local_arbit_count, sw_global_arbit_count;
     double crossbar_count;
 
     std::vector<InputUnit_d *> m_input_unit;
     std::vector<OutputUnit_d *> m_output_unit;
+    BitSet_d m_active_inports;
     RoutingUnit_d *m_routing_unit;
     VCallocator_d *m_vc_alloc;
     SWallocator_d *m_sw_alloc;
@@ -28,23 +28,33 @@
  * Authors: Niket Agarwal
  */
 
-#include "base/cast.hh"
+#include "base/misc.hh"
+#include "mem/protocol/MachineType.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/InputUnit_d.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/OutputUnit_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/Router_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/RoutingUnit_d.hh"
-#include "mem/ruby/slicc_interface/NetworkMessage.hh"
+
+using namespace std;
 
 RoutingUnit_d::RoutingUnit_d(Router_d *router)
 {
     m_router = router;
     m_routing_table.clear();
     m_weight_table.clear();
+    m_neighbour.clear();
+    m_algorithm = Enums::table;
+    m_mesh_cols = 0;
+    m_x = 0;
+    m_y = 0;
 }
 
 void
-RoutingUnit_d::addRoute(const NetDest& routing_table_entry)
+RoutingUnit_d::addRoute(const NetDest& routing_table_entry, int neighbour)
 {
     m_routing_table.push_back(routing_table_entry);
+    m_neighbour.push_back(neighbour);
 }
 
 void
@@ -53,6 +63,109 @@ RoutingUnit_d::addWeight(int link_weight)
     m_weight_table.push_back(link_weight);
 }
 
+void
+RoutingUnit_d::buildTable()
+{
+    GarnetNetwork_d *net = m_router->get_net_ptr();
+    m_algorithm = net->getRoutingAlgorithm();
+
+    if (m_algorithm != Enums::table) {
+        int rows = net->getMeshRows();
+        int num_routers = net->getNumRouters();
+        if (rows <= 0 || num_routers % rows != 0) {
+            fatal("%s routing needs mesh_rows to divide the %d routers\n",
+                  Enums::GarnetRoutingStrings[m_algorithm], num_routers);
+        }
+        m_mesh_cols = num_routers / rows;
+        m_x = m_router->get_id() % m_mesh_cols;
+        m_y = m_router->get_id() / m_mesh_cols;
+    }
+
+    int num_nodes = MachineType_base_number(MachineType_NUM);
+    m_route.assign(num_nodes, -1);
+    m_alt_route.assign(num_nodes, -1);
+
+    // The routes hold every port on a shortest path to each node.  Table
+    // routing keeps the lightest, as the scan it replaces did.
+    vector<int> candidates;
+    NodeID node = 0;
+    for (int m = 0; m < MachineType_NUM; m++) {
+        for (NodeID i = 0; i < MachineType_base_count((MachineType)m);
+             i++, node++) {
+            MachineID mach = {(MachineType)m, i};
+            int min_weight = INFINITE_;
+            candidates.clear();
+            for (int link = 0; link < m_routing_table.size(); link++) {
+                if (!m_routing_table[link].isElement(mach))
+                    continue;
+                candidates.push_back(link);
+                if (m_weight_table[link] < min_weight) {
+                    m_route[node] = link;
+                    min_weight = m_weight_table[link];
+                }
+            }
+
+            if (m_algorithm == Enums::table || candidates.size() < 2)
+                continue;
+
+            int x_first = pickPort(candidates, true, false);
+            int y_first = pickPort(candidates, false, false);
+            int west = pickPort(candidates, true, true);
+
+            if (m_algorithm == Enums::xy && x_first != -1) {
+                m_route[node] = x_first;
+            } else if (m_algorithm == Enums::yx && y_first != -1) {
+                m_route[node] = y_first;
+            } else if (m_algorithm == Enums::west_first && west != -1) {
+                // every westward hop is taken first, without a choice
+                m_route[node] = west;
+            } else if ((m_algorithm == Enums::west_first ||
+                        m_algorithm == Enums::minimal_adaptive) &&
+                       x_first != -1) {
+                m_route[node] = x_first;
+                if (y_first != x_first)
+                    m_alt_route[node] = y_first;
+            }
+        }
+    }
+}
+
+int
+RoutingUnit_d::pickPort(const vector<int>& candidates, bool x_first,
+                        bool west_only) const
+{
+    int x_port = -1;
+    int y_port = -1;
+    for (int i = 0; i < candidates.size(); i++) {
+        int neighbour = m_neighbour[candidates[i]];
+        if (neighbour < 0)
+            continue;
+        int dx = neighbour % m_mesh_cols - m_x;
+        int dy = neighbour / m_mesh_cols - m_y;
+        if (dx != 0 && x_port == -1 && (!west_only || dx < 0))
+            x_port = candidates[i];
+        else if (dy != 0 && y_port == -1)
+            y_port = candidates[i];
+    }
+
+    if (west_only)
+        return x_port;
+    if (x_first)
+        return x_port != -1 ? x_port : y_port;
+    return y_port != -1 ? y_port : x_port;
+}
+
+int
+RoutingUnit_d::freeCredits(int outport, int vnet) const
+{
+    OutputUnit_d *output_unit = m_router->get_outputUnit_ref()[outport];
+    int vc_per_vnet = m_router->get_vc_per_vnet();
+    int credits = 0;
+    for (int vc = vnet * vc_per_vnet; vc < (vnet + 1) * vc_per_vnet; vc++)
+        credits += output_unit->get_credit_cnt(vc);
+    return credits;
+}
+
 void
 RoutingUnit_d::RC_stage(flit_d *t_flit, InputUnit_d *in_unit, int invc)
 {
@@ -65,26 +178,24 @@ RoutingUnit_d::RC_stage(flit_d *t_flit, InputUnit_d *in_unit, int invc)
 int
 RoutingUnit_d::routeCompute(flit_d *t_flit)
 {
-    MsgPtr msg_ptr = t_flit->get_msg_ptr();
-    NetworkMessage* net_msg_ptr = safe_cast<NetworkMessage *>(msg_ptr.get());
-    NetDest msg_destination = net_msg_ptr->getInternalDestination();
-
-    int output_link = -1;
-    int min_weight = INFINITE_;
-
-    for (int link = 0; link < m_routing_table.size(); link++) {
-        if (msg_destination.intersectionIsNotEmpty(m_routing_table[link])) {
-            if (m_weight_table[link] >= min_weight)
-                continue;
-            output_link = link;
-            min_weight = m_weight_table[link];
-        }
-    }
+    int dest = t_flit->get_dest();
+    assert(dest >= 0 && dest < m_route.size());
 
+    int output_link = m_route[dest];
     if (output_link == -1) {
         fatal("Fatal Error:: No Route exists from this Router.");
         exit(0);
     }
 
+    // Adaptive algorithms take the other productive port when it has
+    // more room downstream.  Packets of an ordered vnet all follow the
+    // same path so they cannot overtake each other.
+    int alt_link = m_alt_route[dest];
+    int vnet = t_flit->get_vnet();
+    if (alt_link != -1 && !m_router->get_net_ptr()->isVNetOrdered(vnet)) {
+        if (freeCredits(alt_link, vnet) > freeCredits(output_link, vnet))
+            output_link = alt_link;
+    }
+
     return output_link;
 }
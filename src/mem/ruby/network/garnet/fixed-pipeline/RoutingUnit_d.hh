@@ -31,6 +31,9 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_ROUTING_UNIT_D_HH__
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_ROUTING_UNIT_D_HH__
 
+#include <vector>
+
+#include "enums/GarnetRouting.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/flit_d.hh"
@@ -43,15 +46,35 @@ class RoutingUnit_d
 {
   public:
     RoutingUnit_d(Router_d *router);
-    void addRoute(const NetDest& routing_table_entry);
-    int routeCompute(flit_d *t_flit);
+    // neighbour is the router at the far end of the port, -1 for an NI
+    void addRoute(const NetDest& routing_table_entry, int neighbour);
     void addWeight(int link_weight);
+    // Turn the routes into a per destination lookup table, once every
+    // port has been added
+    void buildTable();
+    int routeCompute(flit_d *t_flit);
     void RC_stage(flit_d *t_flit, InputUnit_d *in_unit, int invc);
 
   private:
+    // port among candidates the algorithm routes through, -1 if none
+    int pickPort(const std::vector<int>& candidates, bool x_first,
+                 bool west_only) const;
+    // free downstream credits of a vnet behind an output port
+    int freeCredits(int outport, int vnet) const;
+
     Router_d *m_router;
     std::vector<NetDest> m_routing_table;
     std::vector<int> m_weight_table;
+    std::vector<int> m_neighbour;
+
+    Enums::GarnetRouting m_algorithm;
+    // router coordinates, meaningful for the mesh algorithms only
+    int m_mesh_cols;
+    int m_x, m_y;
+    // destination node -> output port, and the port an adaptive
+    // algorithm may take instead (-1 if there is no choice)
+    std::vector<int> m_route;
+    std::vector<int> m_alt_route;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_ROUTING_UNIT_D_HH__
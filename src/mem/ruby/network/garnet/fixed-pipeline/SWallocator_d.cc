@@ -55,6 +55,8 @@ SWallocator_d::init()
     m_num_outports = m_router->get_num_outports();
     m_round_robin_outport.resize(m_num_outports);
     m_round_robin_inport.resize(m_num_inports);
+    m_last_round_robin_inport.resize(m_num_inports);
+    m_requested_outports.resize(m_num_outports);
     m_port_req.resize(m_num_outports);
     m_vc_winners.resize(m_num_outports);
 
@@ -88,12 +90,12 @@ SWallocator_d::wakeup()
 void
 SWallocator_d::arbitrate_inports()
 {
-    // First do round robin arbitration on a set of input vc requests
+    // The round robin pointers of every port move on each cycle, so
+    // that skipping idle ports leaves the arbitration order unchanged
     for (int inport = 0; inport < m_num_inports; inport++) {
-        int invc = m_round_robin_inport[inport];
+        int next_round_robin_invc = m_round_robin_inport[inport];
 
         // Select next round robin vc candidate within valid vnet
-        int next_round_robin_invc = invc;
         do {
             next_round_robin_invc++;
 
@@ -102,16 +104,21 @@ SWallocator_d::arbitrate_inports()
         } while (!((m_router->get_net_ptr())->validVirtualNetwork(
                     get_vnet(next_round_robin_invc))));
 
+        m_last_round_robin_inport[inport] = m_round_robin_inport[inport];
         m_round_robin_inport[inport] = next_round_robin_invc;
+    }
 
-        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
-            invc++;
-            if (invc >= m_num_vcs)
-                invc = 0;
+    // First do round robin arbitration on a set of input vc requests.
+    // Only VCs holding a packet can ask for the switch.
+    const BitSet_d &active_inports = m_router->get_active_inports();
+    for (int inport = active_inports.next(0); inport != -1;
+         inport = active_inports.next(inport + 1)) {
+        const BitSet_d &active_vcs = m_input_unit[inport]->get_active_vcs();
+        int invc = m_last_round_robin_inport[inport];
 
-            if (!((m_router->get_net_ptr())->validVirtualNetwork(
-                get_vnet(invc))))
-                continue;
+        for (int invc_iter = 0; invc_iter < active_vcs.count();
+             invc_iter++) {
+            invc = active_vcs.nextWrap(invc + 1);
 
             if (m_input_unit[inport]->need_stage(invc, ACTIVE_, SA_,
                                                  m_router->curCycle()) &&
@@ -121,6 +128,7 @@ SWallocator_d::arbitrate_inports()
                     int outport = m_input_unit[inport]->get_route(invc);
                     m_local_arbiter_activity++;
                     m_port_req[outport][inport] = true;
+                    m_requested_outports.set(outport);
                     m_vc_winners[outport][inport]= invc;
                     break; // got one vc winner for this port
                 }
@@ -165,6 +173,9 @@ SWallocator_d::arbitrate_outports()
         if (m_round_robin_outport[outport] >= m_num_outports)
             m_round_robin_outport[outport] = 0;
 
+        if (!m_requested_outports.test(outport))
+            continue;
+
         for (int inport_iter = 0; inport_iter < m_num_inports; inport_iter++) {
             inport++;
             if (inport >= m_num_inports)
@@ -215,13 +226,20 @@ SWallocator_d::arbitrate_outports()
     }
 }
 
+// A VC out of credits does not keep the allocator awake, the output
+// unit asks for switch allocation again once a credit comes back
 void
 SWallocator_d::check_for_wakeup()
 {
-    for (int i = 0; i < m_num_inports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
+    const BitSet_d &active_inports = m_router->get_active_inports();
+    for (int i = active_inports.next(0); i != -1;
+         i = active_inports.next(i + 1)) {
+        const BitSet_d &active_vcs = m_input_unit[i]->get_active_vcs();
+        for (int j = active_vcs.next(0); j != -1;
+             j = active_vcs.next(j + 1)) {
             if (m_input_unit[i]->need_stage_nextcycle(j, ACTIVE_, SA_,
-                                                      m_router->curCycle())) {
+                                                      m_router->curCycle()) &&
+                m_input_unit[i]->has_credits(j)) {
                 scheduleEvent(Cycles(1));
                 return;
             }
@@ -240,9 +258,11 @@ SWallocator_d::get_vnet(int invc)
 void
 SWallocator_d::clear_request_vector()
 {
-    for (int i = 0; i < m_num_outports; i++) {
+    for (int i = m_requested_outports.next(0); i != -1;
+         i = m_requested_outports.next(i + 1)) {
         for (int j = 0; j < m_num_inports; j++) {
             m_port_req[i][j] = false;
         }
+        m_requested_outports.clear(i);
     }
 }
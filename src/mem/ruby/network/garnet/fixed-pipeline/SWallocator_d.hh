@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/BitSet_d.hh"
 #include "mem/ruby/network/garnet/NetworkHeader.hh"
 
 class Router_d;
@@ -75,8 +76,12 @@ class SWallocator_d : public Consumer
     Router_d *m_router;
     std::vector<int> m_round_robin_outport;
     std::vector<int> m_round_robin_inport;
+    // where this cycle's search of each input port starts from
+    std::vector<int> m_last_round_robin_inport;
     std::vector<std::vector<bool> > m_port_req;
     std::vector<std::vector<int> > m_vc_winners; // a list for each outport
+    // outports with a request in m_port_req
+    BitSet_d m_requested_outports;
     std::vector<InputUnit_d *> m_input_unit;
     std::vector<OutputUnit_d *> m_output_unit;
 };
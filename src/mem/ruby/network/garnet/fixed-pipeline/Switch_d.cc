@@ -42,6 +42,7 @@ Switch_d::Switch_d(Router_d *router)
     m_router = router;
     m_num_vcs = m_router->get_num_vcs();
     m_crossbar_activity = 0;
+    m_num_buffered = 0;
 }
 
 Switch_d::~Switch_d()
@@ -53,6 +54,7 @@ void
 Switch_d::init()
 {
     m_output_unit = m_router->get_outputUnit_ref();
+    m_outport_buffered.assign(m_output_unit.size(), 0);
 
     m_num_inports = m_router->get_num_inports();
     m_switch_buffer.resize(m_num_inports);
@@ -67,7 +69,8 @@ Switch_d::wakeup()
     DPRINTF(RubyNetwork, "Switch woke up at time: %lld\n",
             m_router->curCycle());
 
-    for (int inport = 0; inport < m_num_inports; inport++) {
+    for (int inport = 0; inport < m_num_inports && m_num_buffered > 0;
+         inport++) {
         if (!m_switch_buffer[inport]->isReady(m_router->curCycle()))
             continue;
         flit_d *t_flit = m_switch_buffer[inport]->peekTopFlit();
@@ -79,6 +82,8 @@ Switch_d::wakeup()
             // This will take care of waking up the Network Link
             m_output_unit[outport]->insert_flit(t_flit);
             m_switch_buffer[inport]->getTopFlit();
+            m_outport_buffered[outport]--;
+            m_num_buffered--;
             m_crossbar_activity++;
         }
     }
@@ -88,6 +93,9 @@ Switch_d::wakeup()
 void
 Switch_d::check_for_wakeup()
 {
+    if (m_num_buffered == 0)
+        return;
+
     for (int inport = 0; inport < m_num_inports; inport++) {
         if (m_switch_buffer[inport]->isReadyForNext(m_router->curCycle())) {
             scheduleEvent(Cycles(1));
@@ -52,9 +52,19 @@ class Switch_d : public Consumer
     void print(std::ostream& out) const {};
 
     inline void update_sw_winner(int inport, flit_d *t_flit)
-    { m_switch_buffer[inport]->insert(t_flit); }
+    {
+        m_switch_buffer[inport]->insert(t_flit);
+        m_outport_buffered[t_flit->get_outport()]++;
+        m_num_buffered++;
+    }
+
+    // true if a flit is waiting to cross the switch to outport
+    inline bool has_flit_for(int outport)
+    { return m_outport_buffered[outport] > 0; }
 
     inline double get_crossbar_count() { return m_crossbar_activity; }
+    // a bypassing flit crosses the crossbar without being buffered
+    inline void increment_crossbar_activity() { m_crossbar_activity++; }
 
     uint32_t functionalWrite(Packet *pkt);
 
@@ -62,6 +72,9 @@ class Switch_d : public Consumer
     int m_num_vcs;
     int m_num_inports;
     double m_crossbar_activity;
+    // flits waiting in the switch buffers, in all and per outport
+    int m_num_buffered;
+    std::vector<int> m_outport_buffered;
     Router_d *m_router;
     std::vector<flitBuffer_d *> m_switch_buffer;
     std::vector<OutputUnit_d *> m_output_unit;
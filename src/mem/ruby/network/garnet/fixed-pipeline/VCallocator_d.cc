@@ -95,18 +95,17 @@ VCallocator_d::init()
 void
 VCallocator_d::clear_request_vector()
 {
-    for (int i = 0; i < m_num_outports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
-            if (!m_outvc_is_req[i][j])
-                continue;
-            m_outvc_is_req[i][j] = false;
-            for (int k = 0; k < m_num_inports; k++) {
-                for (int l = 0; l < m_num_vcs; l++) {
-                    m_outvc_req[i][j][k][l] = false;
-                }
+    for (int i = 0; i < m_requested_outvcs.size(); i++) {
+        int outport = m_requested_outvcs[i].first;
+        int outvc = m_requested_outvcs[i].second;
+        m_outvc_is_req[outport][outvc] = false;
+        for (int k = 0; k < m_num_inports; k++) {
+            for (int l = 0; l < m_num_vcs; l++) {
+                m_outvc_req[outport][outvc][k][l] = false;
             }
         }
     }
+    m_requested_outvcs.clear();
 }
 
 void
@@ -167,8 +166,10 @@ VCallocator_d::select_outvc(int inport_iter, int invc_iter)
         if (m_output_unit[outport]->is_vc_idle(outvc, m_router->curCycle())) {
             m_local_arbiter_activity[vnet]++;
             m_outvc_req[outport][outvc][inport_iter][invc_iter] = true;
-            if (!m_outvc_is_req[outport][outvc])
+            if (!m_outvc_is_req[outport][outvc]) {
                 m_outvc_is_req[outport][outvc] = true;
+                m_requested_outvcs.push_back(std::make_pair(outport, outvc));
+            }
             return; // out vc acquired
         }
     }
@@ -177,12 +178,14 @@ VCallocator_d::select_outvc(int inport_iter, int invc_iter)
 void
 VCallocator_d::arbitrate_invcs()
 {
-    for (int inport_iter = 0; inport_iter < m_num_inports; inport_iter++) {
-        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
-            if (!((m_router->get_net_ptr())->validVirtualNetwork(
-                get_vnet(invc_iter))))
-                continue;
-
+    // Only VCs holding a packet can be waiting for an output vc
+    const BitSet_d &active_inports = m_router->get_active_inports();
+    for (int inport_iter = active_inports.next(0); inport_iter != -1;
+         inport_iter = active_inports.next(inport_iter + 1)) {
+        const BitSet_d &active_vcs =
+            m_input_unit[inport_iter]->get_active_vcs();
+        for (int invc_iter = active_vcs.next(0); invc_iter != -1;
+             invc_iter = active_vcs.next(invc_iter + 1)) {
             if (m_input_unit[inport_iter]->need_stage(invc_iter, VC_AB_,
                     VA_, m_router->curCycle())) {
                 if (!is_invc_candidate(inport_iter, invc_iter))
@@ -197,48 +200,44 @@ VCallocator_d::arbitrate_invcs()
 void
 VCallocator_d::arbitrate_outvcs()
 {
-    for (int outport_iter = 0; outport_iter < m_num_outports; outport_iter++) {
-        for (int outvc_iter = 0; outvc_iter < m_num_vcs; outvc_iter++) {
-            if (!m_outvc_is_req[outport_iter][outvc_iter]) {
-                // No requests for this outvc in this cycle
-                continue;
-            }
-
-            int inport = m_round_robin_outvc[outport_iter][outvc_iter].first;
-            int invc_offset =
-                m_round_robin_outvc[outport_iter][outvc_iter].second;
-            int vnet = get_vnet(outvc_iter);
-            int invc_base = vnet*m_vc_per_vnet;
-            int num_vcs_per_vnet = m_vc_per_vnet;
+    // Each input vc asks for a single output vc, so the order the
+    // requested output vcs are visited in does not change the grants
+    for (int i = 0; i < m_requested_outvcs.size(); i++) {
+        int outport_iter = m_requested_outvcs[i].first;
+        int outvc_iter = m_requested_outvcs[i].second;
+        int inport = m_round_robin_outvc[outport_iter][outvc_iter].first;
+        int invc_offset = m_round_robin_outvc[outport_iter][outvc_iter].second;
+        int vnet = get_vnet(outvc_iter);
+        int invc_base = vnet*m_vc_per_vnet;
+        int num_vcs_per_vnet = m_vc_per_vnet;
 
-            m_round_robin_outvc[outport_iter][outvc_iter].second++;
-            if (m_round_robin_outvc[outport_iter][outvc_iter].second >=
-               num_vcs_per_vnet) {
-                m_round_robin_outvc[outport_iter][outvc_iter].second = 0;
-                m_round_robin_outvc[outport_iter][outvc_iter].first++;
-                if (m_round_robin_outvc[outport_iter][outvc_iter].first >=
-                   m_num_inports)
-                    m_round_robin_outvc[outport_iter][outvc_iter].first = 0;
+        m_round_robin_outvc[outport_iter][outvc_iter].second++;
+        if (m_round_robin_outvc[outport_iter][outvc_iter].second >=
+           num_vcs_per_vnet) {
+            m_round_robin_outvc[outport_iter][outvc_iter].second = 0;
+            m_round_robin_outvc[outport_iter][outvc_iter].first++;
+            if (m_round_robin_outvc[outport_iter][outvc_iter].first >=
+               m_num_inports)
+                m_round_robin_outvc[outport_iter][outvc_iter].first = 0;
+        }
+        for (int in_iter = 0; in_iter < m_num_inports*num_vcs_per_vnet;
+                in_iter++) {
+            invc_offset++;
+            if (invc_offset >= num_vcs_per_vnet) {
+                invc_offset = 0;
+                inport++;
+                if (inport >= m_num_inports)
+                    inport = 0;
             }
-            for (int in_iter = 0; in_iter < m_num_inports*num_vcs_per_vnet;
-                    in_iter++) {
-                invc_offset++;
-                if (invc_offset >= num_vcs_per_vnet) {
-                    invc_offset = 0;
-                    inport++;
-                    if (inport >= m_num_inports)
-                        inport = 0;
-                }
-                int invc = invc_base + invc_offset;
-                if (m_outvc_req[outport_iter][outvc_iter][inport][invc]) {
-                    m_global_arbiter_activity[vnet]++;
-                    m_input_unit[inport]->grant_vc(invc, outvc_iter,
-                        m_router->curCycle());
-                    m_output_unit[outport_iter]->update_vc(
-                        outvc_iter, inport, invc);
-                    m_router->swarb_req();
-                    break;
-                }
+            int invc = invc_base + invc_offset;
+            if (m_outvc_req[outport_iter][outvc_iter][inport][invc]) {
+                m_global_arbiter_activity[vnet]++;
+                m_input_unit[inport]->grant_vc(invc, outvc_iter,
+                    m_router->curCycle());
+                m_output_unit[outport_iter]->update_vc(
+                    outvc_iter, inport, invc);
+                m_router->swarb_req();
+                break;
             }
         }
     }
@@ -253,15 +252,31 @@ VCallocator_d::get_vnet(int invc)
     return vnet;
 }
 
+// A VC whose output port has no idle vc in its vnet does not keep the
+// allocator awake, the output unit asks for allocation again once one
+// of them is freed
 void
 VCallocator_d::check_for_wakeup()
 {
-    for (int i = 0; i < m_num_inports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
-            if (m_input_unit[i]->need_stage_nextcycle(j, VC_AB_, VA_,
-                   m_router->curCycle())) {
-                scheduleEvent(Cycles(1));
-                return;
+    Cycles next_cycle = m_router->curCycle() + Cycles(1);
+    const BitSet_d &active_inports = m_router->get_active_inports();
+    for (int i = active_inports.next(0); i != -1;
+         i = active_inports.next(i + 1)) {
+        const BitSet_d &active_vcs = m_input_unit[i]->get_active_vcs();
+        for (int j = active_vcs.next(0); j != -1;
+             j = active_vcs.next(j + 1)) {
+            if (!m_input_unit[i]->need_stage_nextcycle(j, VC_AB_, VA_,
+                   m_router->curCycle()))
+                continue;
+
+            int outport = m_input_unit[i]->get_route(j);
+            int outvc_base = get_vnet(j)*m_vc_per_vnet;
+            for (int k = 0; k < m_vc_per_vnet; k++) {
+                if (m_output_unit[outport]->is_vc_idle(outvc_base + k,
+                                                       next_cycle)) {
+                    scheduleEvent(Cycles(1));
+                    return;
+                }
             }
         }
     }
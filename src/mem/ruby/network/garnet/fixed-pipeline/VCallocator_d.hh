@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/garnet/fixed-pipeline/BitSet_d.hh"
 #include "mem/ruby/network/garnet/NetworkHeader.hh"
 
 class Router_d;
@@ -82,6 +83,8 @@ class VCallocator_d : public Consumer
     std::vector<std::vector<std::vector<std::vector<bool> > > > m_outvc_req;
 
     std::vector<std::vector<bool> > m_outvc_is_req;
+    // (outport, outvc) of every entry set in m_outvc_is_req
+    std::vector<std::pair<int, int> > m_requested_outvcs;
 
     std::vector<InputUnit_d *> m_input_unit;
     std::vector<OutputUnit_d *> m_output_unit;
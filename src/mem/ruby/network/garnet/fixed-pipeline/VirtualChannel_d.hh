@@ -62,6 +62,9 @@ class VirtualChannel_d
         return m_input_buffer->isReady(curTime);
     }
 
+    inline bool isEmpty() { return m_input_buffer->isEmpty(); }
+    inline void set_outvc(int out_vc) { m_output_vc = out_vc; }
+
     inline void
     insertFlit(flit_d *t_flit)
     {
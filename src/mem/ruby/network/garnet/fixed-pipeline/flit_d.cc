@@ -40,6 +40,8 @@ flit_d::flit_d(int id, int  vc, int vnet, int size, MsgPtr msg_ptr,
     m_id = id;
     m_vnet = vnet;
     m_vc = vc;
+    m_dest = -1;
+    m_bypass_hops = 0;
     m_stage.first = I_;
     m_stage.second = m_time;
 
@@ -61,6 +63,7 @@ flit_d::flit_d(int vc, bool is_free_signal, Cycles curTime)
     m_vc = vc;
     m_is_free_signal = is_free_signal;
     m_time = curTime;
+    m_bypass_hops = 0;
 }
 
 void
@@ -45,6 +45,13 @@ class flit_d
     flit_d(int vc, bool is_free_signal, Cycles curTime);
     void set_outport(int port) { m_outport = port; }
     int get_outport() {return m_outport; }
+    // network node the flit is bound for
+    void set_dest(int dest) { m_dest = dest; }
+    int get_dest() { return m_dest; }
+    // routers crossed without being buffered since the flit was last
+    // written into an input buffer
+    int get_bypass_hops() { return m_bypass_hops; }
+    void set_bypass_hops(int hops) { m_bypass_hops = hops; }
     void print(std::ostream& out) const;
     bool is_free_signal() { return m_is_free_signal; }
     int get_size() { return m_size; }
@@ -107,6 +114,8 @@ class flit_d
     flit_type m_type;
     MsgPtr m_msg_ptr;
     int m_outport;
+    int m_dest;
+    int m_bypass_hops;
     Cycles src_delay;
     std::pair<flit_stage, Cycles> m_stage;
 };
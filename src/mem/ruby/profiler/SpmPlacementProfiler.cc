@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <map>
+
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "mem/ruby/profiler/SpmPlacementProfiler.hh"
+#include "mem/ruby/system/System.hh"
+#include "sim/core.hh"
+
+using namespace std;
+
+// Size of the stack distance tree it starts with and never shrinks below
+static const uint64 MinStamps = 1 << 16;
+
+SpmPlacementProfiler*
+SpmPlacementProfilerParams::create()
+{
+    return new SpmPlacementProfiler(this);
+}
+
+SpmPlacementProfiler::SpmPlacementProfiler(const Params *p)
+    : SimObject(p), m_spm_size(p->spm_size), m_spm_latency(p->spm_latency),
+    m_max_regions(p->max_regions), m_granularity(p->granularity),
+    m_move_latency(p->move_latency), m_max_candidates(p->max_candidates),
+    m_output_file(p->output_file), m_block_size(0), m_stamp(0)
+{
+    m_stamp_tree.resize(MinStamps + 1, 0);
+
+    registerExitCallback(new MakeCallback<SpmPlacementProfiler,
+                         &SpmPlacementProfiler::writePlacement>(this));
+}
+
+SpmPlacementProfiler::~SpmPlacementProfiler()
+{
+}
+
+void
+SpmPlacementProfiler::init()
+{
+    m_block_size = RubySystem::getBlockSizeBytes();
+    if (!isPowerOf2(m_granularity) || m_granularity < m_block_size)
+        fatal("%s: granularity must be a power of two of at least %d "
+              "bytes\n", name(), m_block_size);
+    if (m_spm_size < m_granularity)
+        fatal("%s: the spm holds less than one %d byte granule\n", name(),
+              m_granularity);
+    if (m_max_regions <= 0)
+        fatal("%s: max_regions must be positive\n", name());
+}
+
+void
+SpmPlacementProfiler::profileAccess(const Address& address,
+                                    RubyRequestType type, Cycles latency)
+{
+    Address line_address(address);
+    line_address.makeLineAddress();
+
+    pair<LineMap::iterator, bool> r =
+        m_lines.insert(make_pair(line_address, LineRecord()));
+    LineRecord &record = r.first->second;
+    if (r.second)
+        m_lines_touched++;
+
+    if (type == RubyRequestType_ST || type == RubyRequestType_ATOMIC ||
+        type == RubyRequestType_RMW_Write ||
+        type == RubyRequestType_Locked_RMW_Write ||
+        type == RubyRequestType_Store_Conditional) {
+        record.m_writes++;
+    } else {
+        record.m_reads++;
+    }
+    record.m_latency += latency;
+    m_accesses++;
+
+    if (m_stamp + 1 >= m_stamp_tree.size())
+        compactStamps();
+
+    if (record.m_stamp != 0) {
+        // Every line holds one stamp, so the lines touched since this
+        // one are those whose stamp is newer
+        uint64 distance = m_lines.size() - countStamps(record.m_stamp);
+        m_reuse_distance.sample(distance);
+        record.m_reuses++;
+        record.m_reuse_distance += distance;
+        markStamp(record.m_stamp, -1);
+    }
+
+    record.m_stamp = ++m_stamp;
+    markStamp(record.m_stamp, 1);
+}
+
+void
+SpmPlacementProfiler::markStamp(uint64 stamp, int64 delta)
+{
+    for (uint64 i = stamp; i < m_stamp_tree.size(); i += i & -i)
+        m_stamp_tree[i] += delta;
+}
+
+uint64
+SpmPlacementProfiler::countStamps(uint64 stamp) const
+{
+    int64 count = 0;
+    for (uint64 i = stamp; i > 0; i -= i & -i)
+        count += m_stamp_tree[i];
+    return count;
+}
+
+void
+SpmPlacementProfiler::compactStamps()
+{
+    vector<pair<uint64, LineRecord *> > live;
+    live.reserve(m_lines.size());
+    for (LineMap::iterator it = m_lines.begin(); it != m_lines.end(); ++it) {
+        // A line seen for the first time is not stamped yet
+        if (it->second.m_stamp != 0)
+            live.push_back(make_pair(it->second.m_stamp, &it->second));
+    }
+    sort(live.begin(), live.end());
+
+    // Only the order of the stamps matters, so number them 1..n and
+    // leave as much room again for new ones
+    uint64 size = max<uint64>(2 * live.size(), MinStamps);
+    m_stamp_tree.assign(size + 1, 0);
+    for (uint64 i = 1; i <= live.size(); i++) {
+        live[i - 1].second->m_stamp = i;
+        m_stamp_tree[i] += 1;
+        uint64 parent = i + (i & -i);
+        if (parent <= size)
+            m_stamp_tree[parent] += m_stamp_tree[i];
+    }
+    m_stamp = live.size();
+}
+
+bool
+SpmPlacementProfiler::gainGreater(const Candidate& a, const Candidate& b)
+{
+    if (a.m_gain != b.m_gain)
+        return a.m_gain > b.m_gain;
+    return a.m_base < b.m_base;
+}
+
+vector<SpmPlacementProfiler::Candidate>
+SpmPlacementProfiler::buildCandidates() const
+{
+    map<Addr, Granule> granules;
+    for (LineMap::const_iterator it = m_lines.begin(); it != m_lines.end();
+         ++it) {
+        Addr base = it->first.getAddress() & ~(Addr)(m_granularity - 1);
+        map<Addr, Granule>::iterator g = granules.find(base);
+        if (g == granules.end()) {
+            Granule empty = { 0, 0, 0, 0, 0 };
+            g = granules.insert(make_pair(base, empty)).first;
+        }
+        const LineRecord &record = it->second;
+        g->second.reads += record.m_reads;
+        g->second.writes += record.m_writes;
+        g->second.latency += record.m_latency;
+        g->second.reuses += record.m_reuses;
+        g->second.reuse_distance += record.m_reuse_distance;
+    }
+
+    // A granule is moved in whole, and moved out again if written
+    int64 granule_lines = m_granularity / m_block_size;
+    int capacity = m_spm_size / m_granularity;
+
+    // Runs of adjacent granules that gain from the SPM, cut to the size
+    // of the SPM
+    vector<Candidate> candidates;
+    Candidate run = Candidate();
+    bool open = false;
+    for (map<Addr, Granule>::const_iterator it = granules.begin();
+         it != granules.end(); ++it) {
+        const Granule &g = it->second;
+        int64 moves = g.writes != 0 ? 2 * granule_lines : granule_lines;
+        int64 gain = (int64)g.latency -
+            (int64)((g.reads + g.writes) * m_spm_latency) -
+            moves * (int64)m_move_latency;
+        if (gain <= 0) {
+            if (open)
+                candidates.push_back(run);
+            open = false;
+            continue;
+        }
+
+        if (open && run.m_granules < capacity &&
+            it->first == run.m_base + run.m_granules * m_granularity) {
+            run.m_granules++;
+            run.m_gain += gain;
+            run.m_reads += g.reads;
+            run.m_writes += g.writes;
+            run.m_reuses += g.reuses;
+            run.m_reuse_distance += g.reuse_distance;
+        } else {
+            if (open)
+                candidates.push_back(run);
+            run.m_base = it->first;
+            run.m_granules = 1;
+            run.m_gain = gain;
+            run.m_reads = g.reads;
+            run.m_writes = g.writes;
+            run.m_reuses = g.reuses;
+            run.m_reuse_distance = g.reuse_distance;
+            open = true;
+        }
+    }
+    if (open)
+        candidates.push_back(run);
+
+    sort(candidates.begin(), candidates.end(), gainGreater);
+    if (candidates.size() > m_max_candidates)
+        candidates.resize(m_max_candidates);
+    return candidates;
+}
+
+vector<int>
+SpmPlacementProfiler::choosePlacement(
+    const vector<Candidate>& candidates) const
+{
+    // 0/1 knapsack with two budgets: granules of SPM and region table
+    // entries.  best[k][c] is the most gained with at most k ranges in
+    // at most c granules.
+    int n = candidates.size();
+    int regions = m_max_regions;
+    int capacity = m_spm_size / m_granularity;
+    int row = capacity + 1;
+    int plane = (regions + 1) * row;
+
+    vector<int64> best(plane, 0);
+    vector<bool> take((size_t)n * plane, false);
+    for (int i = 0; i < n; i++) {
+        int w = candidates[i].m_granules;
+        int64 v = candidates[i].m_gain;
+        for (int k = regions; k > 0; k--) {
+            for (int c = capacity; c >= w; c--) {
+                int64 with = best[(k - 1) * row + c - w] + v;
+                if (with > best[k * row + c]) {
+                    best[k * row + c] = with;
+                    take[(size_t)i * plane + k * row + c] = true;
+                }
+            }
+        }
+    }
+
+    vector<int> chosen;
+    int k = regions;
+    int c = capacity;
+    for (int i = n - 1; i >= 0; i--) {
+        if (take[(size_t)i * plane + k * row + c]) {
+            chosen.push_back(i);
+            k--;
+            c -= candidates[i].m_granules;
+        }
+    }
+    // Candidates are sorted by gain, so this ranks the placement
+    sort(chosen.begin(), chosen.end());
+    return chosen;
+}
+
+void
+SpmPlacementProfiler::printPlacement(ostream& out) const
+{
+    vector<Candidate> candidates = buildCandidates();
+    vector<int> chosen = choosePlacement(candidates);
+
+    uint64 accesses = 0;
+    uint64 latency = 0;
+    for (LineMap::const_iterator it = m_lines.begin(); it != m_lines.end();
+         ++it) {
+        accesses += it->second.m_reads + it->second.m_writes;
+        latency += it->second.m_latency;
+    }
+
+    ccprintf(out, "# spm placement for %s\n", name());
+    ccprintf(out, "# %d byte spm, %d regions, %d byte granules, "
+             "%d cycle spm latency\n", m_spm_size, m_max_regions,
+             m_granularity, (uint64)m_spm_latency);
+    ccprintf(out, "# %d accesses to %d lines took %d cycles\n", accesses,
+             m_lines.size(), latency);
+    ccprintf(out, "# region base size offset gain_cycles reads writes "
+             "mean_reuse_distance\n");
+
+    // Ranges are packed into the SPM in rank order
+    vector<bool> mapped(candidates.size(), false);
+    Addr offset = 0;
+    int64 gain = 0;
+    for (int i = 0; i < chosen.size(); i++) {
+        const Candidate &cand = candidates[chosen[i]];
+        Addr size = cand.m_granules * m_granularity;
+        double reuse = cand.m_reuses == 0 ? 0 :
+            (double)cand.m_reuse_distance / cand.m_reuses;
+        ccprintf(out, "%d %#x %d %#x %d %d %d %.1f\n", i, cand.m_base, size,
+                 offset, cand.m_gain, cand.m_reads, cand.m_writes, reuse);
+        mapped[chosen[i]] = true;
+        offset += size;
+        gain += cand.m_gain;
+    }
+    ccprintf(out, "# %d bytes mapped, %d cycles gained\n", offset, gain);
+
+    // The next best ranges, should the placement be tuned by hand
+    ccprintf(out, "# not mapped: base size gain_cycles reads writes "
+             "mean_reuse_distance\n");
+    int listed = 0;
+    for (int i = 0; i < candidates.size() && listed < m_max_regions; i++) {
+        if (mapped[i])
+            continue;
+        const Candidate &cand = candidates[i];
+        double reuse = cand.m_reuses == 0 ? 0 :
+            (double)cand.m_reuse_distance / cand.m_reuses;
+        ccprintf(out, "# %#x %d %d %d %d %.1f\n", cand.m_base,
+                 cand.m_granules * m_granularity, cand.m_gain, cand.m_reads,
+                 cand.m_writes, reuse);
+        listed++;
+    }
+}
+
+void
+SpmPlacementProfiler::writePlacement()
+{
+    string filename = m_output_file.empty() ?
+        name() + ".spm_placement" : m_output_file;
+    ostream *os = simout.create(filename);
+    printPlacement(*os);
+    simout.close(os);
+}
+
+void
+SpmPlacementProfiler::print(ostream& out) const
+{
+    out << name() << " SpmPlacementProfiler: " << m_lines.size()
+        << " lines profiled" << endl;
+}
+
+void
+SpmPlacementProfiler::regStats()
+{
+    m_accesses
+        .name(name() + ".accesses")
+        .desc("number of demand accesses profiled")
+        ;
+
+    m_lines_touched
+        .name(name() + ".lines_touched")
+        .desc("number of distinct lines touched")
+        ;
+
+    m_reuse_distance
+        .init(16)
+        .name(name() + ".reuse_distance")
+        .desc("distinct lines touched between two accesses to a line")
+        .flags(Stats::nozero | Stats::pdf)
+        ;
+}
+
+void
+SpmPlacementProfiler::resetStats()
+{
+    m_lines.clear();
+    m_stamp_tree.assign(MinStamps + 1, 0);
+    m_stamp = 0;
+}
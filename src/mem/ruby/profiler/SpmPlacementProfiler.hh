@@ -0,0 +1,150 @@
+#ifndef __MEM_RUBY_PROFILER_SPMPLACEMENTPROFILER_HH__
+#define __MEM_RUBY_PROFILER_SPMPLACEMENTPROFILER_HH__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/hashmap.hh"
+#include "base/statistics.hh"
+#include "mem/protocol/RubyRequestType.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/TypeDefines.hh"
+#include "params/SpmPlacementProfiler.hh"
+#include "sim/sim_object.hh"
+
+/**
+ * Profiles the demand data accesses of a sequencer and suggests what to
+ * pin in a scratchpad.  For every line the profiler counts reads and
+ * writes, the cycles the accesses took and the LRU stack distance of
+ * each reuse, that is the number of distinct lines touched since the
+ * last access to the line.
+ *
+ * At exit the lines are grouped into granules and runs of adjacent
+ * granules that would gain from the SPM become candidate ranges.  A
+ * range gains the cycles its accesses took in the caches, less what
+ * they would take in the SPM and the cost of moving the range in and,
+ * if written, out again.  A knapsack over granules and region table
+ * entries picks the ranges to map, which are written out ranked by gain
+ * with the offsets to map them at.
+ *
+ * Accesses served by an SPM are not profiled; the profile is meant to
+ * be taken with caches only.  Resetting the statistics restarts the
+ * profile, so that it covers the region of interest.
+ */
+class SpmPlacementProfiler : public SimObject
+{
+  public:
+    typedef SpmPlacementProfilerParams Params;
+    SpmPlacementProfiler(const Params *p);
+    ~SpmPlacementProfiler();
+
+    void init();
+
+    // Called by the sequencer as a demand access completes
+    void profileAccess(const Address& address, RubyRequestType type,
+                       Cycles latency);
+
+    // Write the placement list, called at exit
+    void writePlacement();
+    void printPlacement(std::ostream& out) const;
+
+    void regStats();
+    void resetStats();
+
+    void print(std::ostream& out) const;
+
+  private:
+    struct LineRecord
+    {
+        LineRecord()
+            : m_reads(0), m_writes(0), m_latency(0), m_stamp(0),
+              m_reuses(0), m_reuse_distance(0)
+        { }
+
+        uint64 m_reads;
+        uint64 m_writes;
+        // cycles taken by the accesses to the line
+        uint64 m_latency;
+        // position of the last access in the LRU stack
+        uint64 m_stamp;
+        uint64 m_reuses;
+        // sum of the stack distances of the reuses
+        uint64 m_reuse_distance;
+    };
+
+    // The lines of one granule taken together
+    struct Granule
+    {
+        uint64 reads;
+        uint64 writes;
+        uint64 latency;
+        uint64 reuses;
+        uint64 reuse_distance;
+    };
+
+    // A range that may be mapped onto the SPM
+    struct Candidate
+    {
+        Addr m_base;
+        int m_granules;
+        // cycles saved by mapping the range, may be negative
+        int64 m_gain;
+        uint64 m_reads;
+        uint64 m_writes;
+        uint64 m_reuses;
+        uint64 m_reuse_distance;
+    };
+
+    typedef m5::hash_map<Address, LineRecord> LineMap;
+
+    static bool gainGreater(const Candidate& a, const Candidate& b);
+
+    // The stack distance tree is a Fenwick tree over stamps that holds a
+    // one at the stamp of each line's last access
+    void markStamp(uint64 stamp, int64 delta);
+    uint64 countStamps(uint64 stamp) const;
+    // renumber the live stamps 1..n once the tree is full
+    void compactStamps();
+
+    // candidate ranges, best first
+    std::vector<Candidate> buildCandidates() const;
+    // indices of the candidates to map
+    std::vector<int> choosePlacement(
+        const std::vector<Candidate>& candidates) const;
+
+    // Private copy constructor and assignment operator
+    SpmPlacementProfiler(const SpmPlacementProfiler& obj);
+    SpmPlacementProfiler& operator=(const SpmPlacementProfiler& obj);
+
+    uint64 m_spm_size;
+    Cycles m_spm_latency;
+    int m_max_regions;
+    uint64 m_granularity;
+    Cycles m_move_latency;
+    int m_max_candidates;
+    std::string m_output_file;
+    int m_block_size;
+
+    LineMap m_lines;
+    std::vector<int64> m_stamp_tree;
+    // last stamp handed out
+    uint64 m_stamp;
+
+    //! Demand accesses profiled
+    Stats::Scalar m_accesses;
+    //! Distinct lines touched
+    Stats::Scalar m_lines_touched;
+    //! LRU stack distance of each reuse
+    Stats::Histogram m_reuse_distance;
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const SpmPlacementProfiler& obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_PROFILER_SPMPLACEMENTPROFILER_HH__
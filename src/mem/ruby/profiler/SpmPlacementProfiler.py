@@ -0,0 +1,20 @@
+from m5.params import *
+from m5.SimObject import SimObject
+
+class SpmPlacementProfiler(SimObject):
+    type = 'SpmPlacementProfiler'
+    cxx_header = "mem/ruby/profiler/SpmPlacementProfiler.hh"
+
+    spm_size = Param.MemorySize("16kB", "capacity of the spm to plan for")
+    spm_latency = Param.Cycles(3, "latency of an access served by the spm")
+    max_regions = Param.Int(8,
+        "number of ranges the spm can map, one per region table entry")
+    granularity = Param.MemorySize("256B",
+        "bytes per candidate granule, a power of two of at least a line")
+    move_latency = Param.Cycles(2,
+        "cycles charged per line moved into or out of the spm")
+    max_candidates = Param.Int(1024,
+        "ranges considered for placement, best first")
+    output_file = Param.String("",
+        "placement list, written to the output directory at exit; "
+        "defaults to <name>.spm_placement")
@@ -56,6 +56,53 @@ AbstractController::init()
     params()->ruby_system->registerAbstractController(this);
 }
 
+void
+AbstractController::regStats()
+{
+    m_stalled_msgs
+        .name(name() + ".stalled_msgs")
+        .desc("messages parked on a wait list by stall_and_wait")
+        .flags(Stats::nozero)
+        ;
+
+    m_stall_depth
+        .init(16)
+        .name(name() + ".stall_depth")
+        .desc("messages waiting on the line when one more is stalled")
+        .flags(Stats::nozero | Stats::pdf)
+        ;
+
+    m_stall_wakeups
+        .name(name() + ".stall_wakeups")
+        .desc("wait lists released")
+        .flags(Stats::nozero)
+        ;
+
+    m_woken_msgs
+        .name(name() + ".woken_msgs")
+        .desc("stalled messages put back in their buffers")
+        .flags(Stats::nozero)
+        ;
+
+    m_sharer_overflows
+        .name(name() + ".sharer_overflows")
+        .desc("sharer sets that ran out of pointers")
+        .flags(Stats::nozero)
+        ;
+
+    m_imprecise_invs
+        .name(name() + ".imprecise_invs")
+        .desc("invalidations sent to a coarse sharer set")
+        .flags(Stats::nozero)
+        ;
+
+    m_imprecise_inv_targets
+        .name(name() + ".imprecise_inv_targets")
+        .desc("L1s those invalidations were sent to")
+        .flags(Stats::nozero)
+        ;
+}
+
 void
 AbstractController::clearStats()
 {
@@ -110,6 +157,17 @@ AbstractController::stallBuffer(MessageBuffer* buf, Address addr)
         m_waiting_buffers[addr] = msgVec;
     }
     (*(m_waiting_buffers[addr]))[m_cur_in_port] = buf;
+
+    m_stalled_msgs++;
+    m_stall_depth.sample(buf->stallMessage(addr));
+}
+
+void
+AbstractController::wakeUpBuffer(MessageBuffer* buf, Address addr)
+{
+    int woken = buf->reanalyzeMessages(addr);
+    m_stall_wakeups++;
+    m_woken_msgs += woken;
 }
 
 void
@@ -124,7 +182,8 @@ AbstractController::wakeUpBuffers(Address addr)
              in_port_rank >= 0;
              in_port_rank--) {
             if ((*(m_waiting_buffers[addr]))[in_port_rank] != NULL) {
-                (*(m_waiting_buffers[addr]))[in_port_rank]->reanalyzeMessages(addr);
+                wakeUpBuffer((*(m_waiting_buffers[addr]))[in_port_rank],
+                             addr);
             }
         }
         delete m_waiting_buffers[addr];
@@ -144,7 +203,8 @@ AbstractController::wakeUpAllBuffers(Address addr)
              in_port_rank >= 0;
              in_port_rank--) {
             if ((*(m_waiting_buffers[addr]))[in_port_rank] != NULL) {
-                (*(m_waiting_buffers[addr]))[in_port_rank]->reanalyzeMessages(addr);
+                wakeUpBuffer((*(m_waiting_buffers[addr]))[in_port_rank],
+                             addr);
             }
         }
         delete m_waiting_buffers[addr];
@@ -169,7 +229,11 @@ AbstractController::wakeUpAllBuffers()
                   vec_iter != buf_iter->second->end();
                   ++vec_iter) {
                   if (*vec_iter != NULL) {
-                      (*vec_iter)->reanalyzeAllMessages();
+                      int woken = (*vec_iter)->reanalyzeAllMessages();
+                      if (woken > 0) {
+                          m_stall_wakeups++;
+                          m_woken_msgs += woken;
+                      }
                   }
              }
              wokeUpMsgVecs.push_back(buf_iter->second);
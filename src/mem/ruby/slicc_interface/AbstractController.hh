@@ -33,6 +33,7 @@
 #include <string>
 
 #include "base/callback.hh"
+#include "base/statistics.hh"
 #include "mem/protocol/AccessPermission.hh"
 #include "mem/ruby/buffers/MessageBuffer.hh"
 #include "mem/ruby/common/Address.hh"
@@ -73,7 +74,7 @@ class AbstractController : public ClockedObject, public Consumer
     virtual void print(std::ostream & out) const = 0;
     virtual void wakeup() = 0;
     virtual void clearStats() = 0;
-    virtual void regStats() = 0;
+    virtual void regStats();
 
     virtual void recordCacheTrace(int cntrl, CacheRecorder* tr) = 0;
     virtual Sequencer* getSequencer() const = 0;
@@ -91,6 +92,12 @@ class AbstractController : public ClockedObject, public Consumer
     virtual void enqueuePrefetch(const Address&, const RubyRequestType&)
     { fatal("Prefetches not implemented!");}
 
+    //! Function for enqueuing a run of consecutive lines from the SPM DMA
+    //! engine. Runs longer than one line only target remote SPMs.
+    virtual void enqueueSpmDma(const Address&, const Address&, const int&,
+                               const bool&)
+    { fatal("SPM DMA not implemented!");}
+
     //! Function for collating statistics from all the controllers of this
     //! particular type. This function should only be called from the
     //! version 0 of this controller type.
@@ -121,13 +128,23 @@ class AbstractController : public ClockedObject, public Consumer
     void profileRequest(const std::string &request);
     //! Profiles the delay associated with messages.
     void profileMsgDelay(uint32_t virtualNetwork, Cycles delay);
+    //! Profiles the sharer set of a line overflowing its pointers
+    void profileSharerOverflow() { m_sharer_overflows++; }
+    //! Profiles an invalidation sent from an imprecise sharer set
+    void profileImpreciseInv(int targets)
+    {
+        m_imprecise_invs++;
+        m_imprecise_inv_targets += targets;
+    }
 
     //! Function for connecting peer controllers
     void connectWithPeer(AbstractController *);
     virtual void getQueuesFromPeer(AbstractController *)
     { fatal("getQueuesFromPeer() should be called only if implemented!"); }
 
+    //! Park the message at the head of buf until addr is woken up
     void stallBuffer(MessageBuffer* buf, Address addr);
+    void wakeUpBuffer(MessageBuffer* buf, Address addr);
     void wakeUpBuffers(Address addr);
     void wakeUpAllBuffers(Address addr);
     void wakeUpAllBuffers();
@@ -168,6 +185,20 @@ class AbstractController : public ClockedObject, public Consumer
     Histogram m_delayHistogram;
     std::vector<Histogram> m_delayVCHistogram;
 
+    //! Messages parked by stall_and_wait
+    Stats::Scalar m_stalled_msgs;
+    //! Messages waiting on the line, the new one included, at each stall
+    Stats::Histogram m_stall_depth;
+    //! Wait lists released and the messages they gave back
+    Stats::Scalar m_stall_wakeups;
+    Stats::Scalar m_woken_msgs;
+
+    //! Sharer sets that overflowed into a coarse vector
+    Stats::Scalar m_sharer_overflows;
+    //! Invalidations sent from imprecise sharer sets, and their targets
+    Stats::Scalar m_imprecise_invs;
+    Stats::Scalar m_imprecise_inv_targets;
+
     //! Callback class used for collating statistics from all the
     //! controller of this type.
     class StatsCallback : public Callback
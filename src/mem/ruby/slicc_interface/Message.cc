@@ -0,0 +1,3 @@
+#include "mem/ruby/slicc_interface/Message.hh"
+
+uint64_t Message::s_num_live = 0;
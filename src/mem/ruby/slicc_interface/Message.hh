@@ -44,15 +44,19 @@ class Message : public RefCounted
         : m_time(curTime),
           m_LastEnqueueTime(curTime),
           m_DelayedTicks(0)
-    { }
+    { s_num_live++; }
 
     Message(const Message &other)
         : m_time(other.m_time),
           m_LastEnqueueTime(other.m_LastEnqueueTime),
           m_DelayedTicks(other.m_DelayedTicks)
-    { }
+    { s_num_live++; }
 
-    virtual ~Message() { }
+    virtual ~Message() { s_num_live--; }
+
+    // Messages in existence anywhere: in buffers, in the network or held
+    // by a controller.  Zero means no message can carry a stale copy.
+    static uint64_t numLive() { return s_num_live; }
 
     virtual Message* clone() const = 0;
     virtual void print(std::ostream& out) const = 0;
@@ -84,6 +88,8 @@ class Message : public RefCounted
     Tick m_time;
     Tick m_LastEnqueueTime; // my last enqueue time
     Tick m_DelayedTicks; // my delayed cycles
+
+    static uint64_t s_num_live;
 };
 
 inline std::ostream&
@@ -0,0 +1,77 @@
+#ifndef __MEM_RUBY_SLICC_INTERFACE_MESSAGEPOOL_HH__
+#define __MEM_RUBY_SLICC_INTERFACE_MESSAGEPOOL_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+/**
+ * A free list for one message type.  Every coherence transaction creates
+ * and destroys a handful of messages, so each message class routes its
+ * operator new and delete through a pool and recycles its objects rather
+ * than going to the heap each time.  Objects are carved out of chunks of
+ * ChunkObjects at a time.  Chunks are kept until exit, since messages may
+ * still sit in buffers when the simulator is torn down.
+ */
+class MessagePool
+{
+  public:
+    MessagePool(size_t size)
+        : m_object_size(size),
+          m_slot_size((std::max(size, sizeof(FreeSlot)) + SlotAlign - 1) &
+                      ~(SlotAlign - 1)),
+          m_free(NULL)
+    {
+    }
+
+    void *
+    allocate(size_t size)
+    {
+        // A class derived from the pooled one is bigger than a slot
+        if (size != m_object_size)
+            return ::operator new(size);
+        if (m_free == NULL)
+            refill();
+        FreeSlot *slot = m_free;
+        m_free = slot->next;
+        return slot;
+    }
+
+    void
+    release(void *ptr, size_t size)
+    {
+        if (ptr == NULL)
+            return;
+        if (size != m_object_size) {
+            ::operator delete(ptr);
+            return;
+        }
+        FreeSlot *slot = static_cast<FreeSlot *>(ptr);
+        slot->next = m_free;
+        m_free = slot;
+    }
+
+  private:
+    struct FreeSlot
+    {
+        FreeSlot *next;
+    };
+
+    static const size_t ChunkObjects = 64;
+    static const size_t SlotAlign = 16;
+
+    void
+    refill()
+    {
+        char *chunk =
+            static_cast<char *>(::operator new(m_slot_size * ChunkObjects));
+        for (size_t i = 0; i < ChunkObjects; i++)
+            release(chunk + i * m_slot_size, m_object_size);
+    }
+
+    size_t m_object_size;
+    size_t m_slot_size;
+    FreeSlot *m_free;
+};
+
+#endif // __MEM_RUBY_SLICC_INTERFACE_MESSAGEPOOL_HH__
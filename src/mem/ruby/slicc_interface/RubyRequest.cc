@@ -4,6 +4,8 @@
 
 using namespace std;
 
+MessagePool RubyRequest::s_pool(sizeof(RubyRequest));
+
 void
 RubyRequest::print(ostream& out) const
 {
@@ -36,6 +36,7 @@
 #include "mem/protocol/RubyAccessMode.hh"
 #include "mem/protocol/RubyRequestType.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/slicc_interface/MessagePool.hh"
 
 class RubyRequest : public Message
 {
@@ -73,6 +74,13 @@ class RubyRequest : public Message
     RubyRequest(Tick curTime) : Message(curTime) {}
     RubyRequest* clone() const { return new RubyRequest(*this); }
 
+    static void *operator new(size_t size) { return s_pool.allocate(size); }
+    static void
+    operator delete(void *ptr, size_t size)
+    {
+        s_pool.release(ptr, size);
+    }
+
     const Address& getLineAddress() const { return m_LineAddress; }
     const Address& getPhysicalAddress() const { return m_PhysicalAddress; }
     const RubyRequestType& getType() const { return m_Type; }
@@ -84,6 +92,9 @@ class RubyRequest : public Message
     void print(std::ostream& out) const;
     bool functionalRead(Packet *pkt);
     bool functionalWrite(Packet *pkt);
+
+  private:
+    static MessagePool s_pool;
 };
 
 inline std::ostream&
@@ -81,6 +81,15 @@ makeLineAddress(Address addr)
     return result;
 }
 
+// Line address of the line following the one holding addr
+inline Address
+makeNextLineAddress(Address addr)
+{
+    Address result = addr;
+    result.makeNextStrideAddress(1);
+    return result;
+}
+
 inline int
 addressOffset(Address addr)
 {
@@ -154,4 +163,8 @@ testAndWrite(Address addr, DataBlock& blk, Packet *pkt)
     return false;
 }
 
+// True if the line lies in a range some SPM declared non-coherent.
+// Defined with the SPM so that protocols without one need not include it.
+bool isNonCoherentSpmLine(const Address& addr);
+
 #endif // __MEM_RUBY_SLICC_INTERFACE_RUBYSLICCUTIL_HH__
@@ -0,0 +1,17 @@
+from m5.params import *
+from ClockedObject import ClockedObject
+
+class SpmDMAEngine(ClockedObject):
+    type = 'SpmDMAEngine'
+    cxx_class = 'SpmDMAEngine'
+    cxx_header = "mem/ruby/structures/SpmDMAEngine.hh"
+
+    spm = Param.RubySpm("scratchpad this engine moves lines into and out of")
+    max_outstanding = Param.UInt32(16,
+        "Number of lines that may be in flight at once")
+    burst_size = Param.UInt32(4,
+        "Number of requests handed to the controller per cycle")
+    remote_batch = Param.UInt32(4,
+        "Number of lines packed into one request to a remote spm")
+    max_remote_requests = Param.UInt32(4,
+        "Number of requests to remote spms that may be in flight at once")
@@ -0,0 +1,356 @@
+#include <algorithm>
+
+#include "base/misc.hh"
+#include "debug/RubySpmDMA.hh"
+#include "mem/ruby/structures/SpmDMAEngine.hh"
+#include "mem/ruby/system/System.hh"
+
+using namespace std;
+
+SpmDMAEngine*
+SpmDMAEngineParams::create()
+{
+    return new SpmDMAEngine(this);
+}
+
+SpmDMAEngine::SpmDMAEngine(const Params *p)
+    : ClockedObject(p), m_spm(p->spm), m_controller(NULL),
+    m_max_outstanding(p->max_outstanding), m_burst_size(p->burst_size),
+    m_remote_batch(p->remote_batch),
+    m_max_remote_requests(p->max_remote_requests),
+    m_block_size(RubySystem::getBlockSizeBytes()), m_next_id(0),
+    issueEvent(this)
+{
+    assert(m_max_outstanding > 0);
+    assert(m_burst_size > 0);
+    assert(m_remote_batch > 0);
+    assert(m_max_remote_requests > 0);
+    m_spm->setDMAEngine(this);
+}
+
+SpmDMAEngine::~SpmDMAEngine()
+{
+}
+
+int
+SpmDMAEngine::startTransfer(Addr src, Addr dst, Addr length, Addr stride,
+                            bool move_in, Event *completion)
+{
+    Addr mem_base = move_in ? src : dst;
+    Addr spm_base = move_in ? dst : src;
+
+    if (length == 0 || length % m_block_size != 0 ||
+        mem_base % m_block_size != 0 || spm_base % m_block_size != 0 ||
+        stride < m_block_size || stride % m_block_size != 0) {
+        warn("%s: rejecting transfer src %#x dst %#x len %d stride %d, "
+             "addresses, length and stride must be line multiples\n",
+             name(), src, dst, length, stride);
+        numRejected++;
+        return -1;
+    }
+
+    // The SPM side is checked against the mappings as they will be once
+    // the SPMCONFIG requests already queued are applied; the transfer
+    // does not start before then
+    if (!m_spm->isRangeInPendingSpm(spm_base, length)) {
+        warn("%s: rejecting transfer, [%#x, %#x) is not in one SPM "
+             "mapping\n", name(), spm_base, spm_base + length);
+        numRejected++;
+        return -1;
+    }
+
+    // The memory side is either plain memory or lies entirely in one
+    // mapping of one other SPM.  A window may sit between the first and
+    // last lines, so plain memory is checked over the whole span.
+    uint64 num_lines = length / m_block_size;
+    Addr mem_last = mem_base + (num_lines - 1) * stride;
+    Addr mem_span = mem_last + m_block_size - mem_base;
+    ScratchpadMemory *window =
+        ScratchpadMemory::lookupWindow(Address(mem_base));
+    bool mem_ok = window == NULL ?
+        !ScratchpadMemory::overlapsAnyWindow(mem_base, mem_span) :
+        window != m_spm && window->isRangeInSpm(mem_base, mem_span);
+    if (!mem_ok) {
+        warn("%s: rejecting transfer, memory side [%#x, %#x] must be plain "
+             "memory or lie in a single remote SPM\n", name(), mem_base,
+             mem_last);
+        numRejected++;
+        return -1;
+    }
+
+    SpmDMADescriptor desc;
+    desc.m_id = m_next_id++;
+    desc.m_mem_base = mem_base;
+    desc.m_stride = stride;
+    desc.m_spm_base = spm_base;
+    desc.m_num_lines = num_lines;
+    desc.m_move_in = move_in;
+    desc.m_remote = window != NULL;
+    desc.m_issued = 0;
+    desc.m_completed = 0;
+    desc.m_completion = completion;
+    desc.m_config_seq = m_spm->getConfigsQueued();
+    desc.m_start_time = curCycle();
+    m_descriptors.push_back(desc);
+    numTransfers++;
+
+    DPRINTF(RubySpmDMA, "transfer %d: %s %d lines %s %#x stride %d "
+            "spm %#x\n", desc.m_id, move_in ? "move in" : "evict",
+            desc.m_num_lines, desc.m_remote ? "remote" : "mem", mem_base,
+            stride, spm_base);
+
+    scheduleIssue();
+    return desc.m_id;
+}
+
+bool
+SpmDMAEngine::isComplete(int id) const
+{
+    assert(id >= 0 && id < m_next_id);
+    for (deque<SpmDMADescriptor>::const_iterator it = m_descriptors.begin();
+         it != m_descriptors.end(); ++it) {
+        if (it->m_id == id)
+            return false;
+    }
+    return true;
+}
+
+bool
+SpmDMAEngine::setCompletion(int id, Event *completion)
+{
+    assert(id >= 0 && id < m_next_id);
+    for (deque<SpmDMADescriptor>::iterator it = m_descriptors.begin();
+         it != m_descriptors.end(); ++it) {
+        if (it->m_id == id) {
+            it->m_completion = completion;
+            return true;
+        }
+    }
+    return false;
+}
+
+SpmDMAEngine::SpmDMADescriptor*
+SpmDMAEngine::getIssueDescriptor()
+{
+    for (deque<SpmDMADescriptor>::iterator it = m_descriptors.begin();
+         it != m_descriptors.end(); ++it) {
+        if (it->m_issued < it->m_num_lines) {
+            if (it->m_config_seq > m_spm->getConfigsApplied())
+                return NULL;
+            return &(*it);
+        }
+    }
+    return NULL;
+}
+
+void
+SpmDMAEngine::configApplied()
+{
+    scheduleIssue();
+}
+
+void
+SpmDMAEngine::scheduleIssue()
+{
+    if (!issueEvent.scheduled() && getIssueDescriptor() != NULL &&
+        m_inflight.size() < m_max_outstanding) {
+        schedule(issueEvent, clockEdge(Cycles(1)));
+    }
+}
+
+void
+SpmDMAEngine::issueLines()
+{
+    assert(m_controller != NULL);
+
+    for (uint32_t i = 0; i < m_burst_size; i++) {
+        SpmDMADescriptor *desc = getIssueDescriptor();
+        if (desc == NULL)
+            return;
+
+        // A mapping the transfer relied on may have been dropped when
+        // its SPMCONFIG was applied
+        if (desc->m_issued == 0 &&
+            !m_spm->isRangeInSpm(desc->m_spm_base,
+                                 desc->m_num_lines * m_block_size)) {
+            warn("%s: dropping transfer %d, [%#x, %#x) is no longer "
+                 "mapped\n", name(), desc->m_id, desc->m_spm_base,
+                 desc->m_spm_base + desc->m_num_lines * m_block_size);
+            numRejected++;
+            // Nothing of it is in flight, so waiters can be told now
+            deque<SpmDMADescriptor>::iterator it = m_descriptors.begin();
+            while (&(*it) != desc)
+                ++it;
+            if (it->m_completion != NULL && !it->m_completion->scheduled())
+                schedule(it->m_completion, curTick());
+            m_descriptors.erase(it);
+            continue;
+        }
+
+        if (m_inflight.size() >= m_max_outstanding) {
+            // lineDone() restarts the pipeline once a slot frees up
+            numOutstandingStalls++;
+            return;
+        }
+
+        // Local lines go one to a request. Dense runs from a remote
+        // SPM are packed so that the owner can stream them back.
+        uint64 lines = 1;
+        if (desc->m_remote) {
+            if (m_remote_requests.size() >= m_max_remote_requests) {
+                numRemoteStalls++;
+                return;
+            }
+            if (desc->m_stride == m_block_size) {
+                lines = std::min<uint64>(m_remote_batch,
+                                         desc->m_num_lines - desc->m_issued);
+                lines = std::min<uint64>(lines,
+                            m_max_outstanding - m_inflight.size());
+            }
+        }
+
+        Address mem_addr(desc->m_mem_base + desc->m_issued * desc->m_stride);
+        Address spm_addr(desc->m_spm_base + desc->m_issued * m_block_size);
+
+        // An earlier transfer may still own some of the lines; keep
+        // lines in order and try again when they land
+        uint64 free_lines = 0;
+        while (free_lines < lines &&
+               !m_inflight.count(Address(mem_addr.getAddress() +
+                                         free_lines * desc->m_stride))) {
+            free_lines++;
+        }
+        if (free_lines == 0) {
+            DPRINTF(RubySpmDMA, "transfer %d: line %s busy\n",
+                    desc->m_id, mem_addr);
+            return;
+        }
+        lines = free_lines;
+
+        DPRINTF(RubySpmDMA, "transfer %d: issue %d lines from %d mem %s "
+                "spm %s\n", desc->m_id, lines, desc->m_issued, mem_addr,
+                spm_addr);
+
+        for (uint64 j = 0; j < lines; j++) {
+            SpmDMALine &line = m_inflight[Address(mem_addr.getAddress() +
+                                                  j * desc->m_stride)];
+            line.m_id = desc->m_id;
+            line.m_request = mem_addr;
+        }
+        if (desc->m_remote) {
+            m_remote_requests[mem_addr] = lines;
+            numRemoteRequests++;
+        }
+        desc->m_issued += lines;
+        m_controller->enqueueSpmDma(mem_addr, spm_addr, lines,
+                                    desc->m_move_in);
+    }
+
+    scheduleIssue();
+}
+
+void
+SpmDMAEngine::lineDone(const Address& mem_addr)
+{
+    map<Address, SpmDMALine>::iterator inflight = m_inflight.find(mem_addr);
+    assert(inflight != m_inflight.end());
+    int id = inflight->second.m_id;
+    Address request = inflight->second.m_request;
+    m_inflight.erase(inflight);
+
+    deque<SpmDMADescriptor>::iterator it = m_descriptors.begin();
+    while (it->m_id != id) {
+        ++it;
+        assert(it != m_descriptors.end());
+    }
+
+    if (it->m_remote) {
+        map<Address, uint64>::iterator req = m_remote_requests.find(request);
+        assert(req != m_remote_requests.end());
+        if (--req->second == 0)
+            m_remote_requests.erase(req);
+        numRemoteLines++;
+    }
+
+    it->m_completed++;
+    if (it->m_move_in) {
+        numLinesIn++;
+    } else {
+        numLinesOut++;
+    }
+
+    if (it->m_completed == it->m_num_lines) {
+        DPRINTF(RubySpmDMA, "transfer %d: complete\n", id);
+        transferLatency.sample(curCycle() - it->m_start_time);
+        if (it->m_completion != NULL && !it->m_completion->scheduled()) {
+            schedule(it->m_completion, curTick());
+        }
+        m_descriptors.erase(it);
+    }
+
+    scheduleIssue();
+}
+
+void
+SpmDMAEngine::print(ostream& out) const
+{
+    out << name() << " SpmDMAEngine: " << m_descriptors.size()
+        << " transfers, " << m_inflight.size() << " lines in flight, "
+        << m_remote_requests.size() << " remote requests" << endl;
+}
+
+void
+SpmDMAEngine::regStats()
+{
+    numTransfers
+        .name(name() + ".transfers")
+        .desc("number of transfers accepted")
+        ;
+
+    numRejected
+        .name(name() + ".transfers_rejected")
+        .desc("number of transfers rejected for bad arguments")
+        .flags(Stats::nozero)
+        ;
+
+    numLinesIn
+        .name(name() + ".lines_moved_in")
+        .desc("number of lines moved into the spm")
+        ;
+
+    numLinesOut
+        .name(name() + ".lines_evicted")
+        .desc("number of lines evicted from the spm")
+        ;
+
+    numOutstandingStalls
+        .name(name() + ".outstanding_stalls")
+        .desc("number of bursts cut short by the outstanding line limit")
+        .flags(Stats::nozero)
+        ;
+
+    numRemoteRequests
+        .name(name() + ".remote_requests")
+        .desc("number of requests sent to remote spms")
+        .flags(Stats::nozero)
+        ;
+
+    numRemoteLines
+        .name(name() + ".remote_lines")
+        .desc("number of lines moved to or from remote spms")
+        .flags(Stats::nozero)
+        ;
+
+    numRemoteStalls
+        .name(name() + ".remote_request_stalls")
+        .desc("number of bursts cut short by the remote request limit")
+        .flags(Stats::nozero)
+        ;
+
+    transferLatency
+        .init(16)
+        .name(name() + ".transfer_latency")
+        .desc("cycles from accepting a transfer to its last line landing")
+        .flags(Stats::nozero | Stats::pdf)
+        ;
+}
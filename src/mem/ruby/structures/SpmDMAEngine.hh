@@ -0,0 +1,175 @@
+#ifndef __MEM_RUBY_STRUCTURES_SPMDMAENGINE_HH__
+#define __MEM_RUBY_STRUCTURES_SPMDMAENGINE_HH__
+
+// Moves blocks of lines between the memory hierarchy and a scratchpad
+
+#include <deque>
+#include <iostream>
+#include <map>
+
+#include "base/statistics.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
+#include "mem/ruby/system/ScratchpadMemory.hh"
+#include "params/SpmDMAEngine.hh"
+#include "sim/clocked_object.hh"
+
+class SpmDMAEngine : public ClockedObject
+{
+    public:
+        typedef SpmDMAEngineParams Params;
+        SpmDMAEngine(const Params *p);
+        ~SpmDMAEngine();
+
+        /**
+         * Queue a transfer between memory and the scratchpad. The SPM
+         * side of a transfer is always dense, the memory side advances
+         * by stride bytes per line so that tiles can be gathered into
+         * (or scattered out of) the SPM with a single descriptor.
+         *
+         * The memory side may also be the window of another core's SPM,
+         * in which case the lines travel directly between the two L1s.
+         * Dense remote transfers are packed remote_batch lines to a
+         * request, and at most max_remote_requests requests are kept in
+         * flight.
+         *
+         * @param src        First byte to read. A memory address for a
+         *                   move-in, an SPM window address for an eviction.
+         * @param dst        First byte to write.
+         * @param length     Bytes to move, a multiple of the line size.
+         * @param stride     Distance between successive memory lines.
+         * @param move_in    True for memory -> SPM, false for SPM -> memory.
+         * @param completion Scheduled once every line of the transfer has
+         *                   landed, may be NULL.
+         * @return           An id to poll with isComplete(), or -1 if the
+         *                   descriptor was rejected.
+         */
+        int startTransfer(Addr src, Addr dst, Addr length, Addr stride,
+                          bool move_in, Event *completion = NULL);
+
+        //! True once every line of transfer id has been acknowledged
+        bool isComplete(int id) const;
+        //! True if id was handed out by startTransfer()
+        bool isValidId(int id) const { return id >= 0 && id < m_next_id; }
+        /**
+         * Schedule completion once transfer id has completed, replacing
+         * any event given to startTransfer().
+         *
+         * @return False if the transfer has already completed.
+         */
+        bool setCompletion(int id, Event *completion);
+        //! True while any transfer is queued or in flight
+        bool busy() const { return !m_descriptors.empty(); }
+        //! Called by the SPM each time it applies an SPMCONFIG request
+        void configApplied();
+
+        /**
+         * Called by the controller when the line at mem_addr has been
+         * written into the SPM (move-in) or its write back has been
+         * acknowledged by the L2 or the remote SPM (eviction).
+         */
+        void lineDone(const Address& mem_addr);
+
+        void setController(AbstractController *_ctrl)
+        { m_controller = _ctrl; }
+
+        void print(std::ostream& out) const;
+        void regStats();
+
+    private:
+        struct SpmDMADescriptor
+        {
+            int m_id;
+            //! memory side of the transfer, advances by m_stride
+            Addr m_mem_base;
+            Addr m_stride;
+            //! SPM side of the transfer, always dense
+            Addr m_spm_base;
+            uint64 m_num_lines;
+            bool m_move_in;
+            //! memory side is another core's SPM window
+            bool m_remote;
+
+            uint64 m_issued;
+            uint64 m_completed;
+
+            Event *m_completion;
+            //! SPMCONFIG requests that must be applied before it starts
+            uint64 m_config_seq;
+            Cycles m_start_time;
+        };
+
+        struct SpmDMALine
+        {
+            //! transfer the line belongs to
+            int m_id;
+            //! first line of the request that carried it
+            Address m_request;
+        };
+
+        //! hand up to m_burst_size requests to the controller
+        void issueLines();
+        //! schedule the next burst if there is anything left to issue
+        void scheduleIssue();
+
+        //! first descriptor that still has lines to issue, NULL if
+        //! there is none or it waits for an SPMCONFIG request
+        SpmDMADescriptor* getIssueDescriptor();
+
+        ScratchpadMemory *m_spm;
+        AbstractController *m_controller;
+
+        //! upper bound on lines handed to the controller but not done
+        uint32_t m_max_outstanding;
+        //! requests handed to the controller per cycle
+        uint32_t m_burst_size;
+        //! lines packed into one request to a remote SPM
+        uint32_t m_remote_batch;
+        //! upper bound on remote requests in flight
+        uint32_t m_max_remote_requests;
+        //! line size in bytes
+        int m_block_size;
+
+        //! transfers in issue order
+        std::deque<SpmDMADescriptor> m_descriptors;
+        //! memory line -> transfer and request that have it in flight
+        std::map<Address, SpmDMALine> m_inflight;
+        //! first line of each remote request -> lines still outstanding
+        std::map<Address, uint64> m_remote_requests;
+        //! id handed out to the next transfer
+        int m_next_id;
+
+        class SpmDMAIssueEvent : public Event
+        {
+          private:
+            SpmDMAEngine *m_engine_ptr;
+
+          public:
+            SpmDMAIssueEvent(SpmDMAEngine *_engine) : m_engine_ptr(_engine) {}
+            void process() { m_engine_ptr->issueLines(); }
+            const char *description() const { return "SPM DMA issue"; }
+        };
+
+        SpmDMAIssueEvent issueEvent;
+
+        //! Count of descriptors accepted
+        Stats::Scalar numTransfers;
+        //! Count of descriptors rejected for bad arguments
+        Stats::Scalar numRejected;
+        //! Count of lines moved into the SPM
+        Stats::Scalar numLinesIn;
+        //! Count of lines evicted out of the SPM
+        Stats::Scalar numLinesOut;
+        //! Count of bursts cut short by the outstanding limit
+        Stats::Scalar numOutstandingStalls;
+        //! Count of requests sent to remote SPMs
+        Stats::Scalar numRemoteRequests;
+        //! Count of lines moved to or from remote SPMs
+        Stats::Scalar numRemoteLines;
+        //! Count of bursts cut short by the remote request limit
+        Stats::Scalar numRemoteStalls;
+        //! Cycles from accepting a descriptor to its last line landing
+        Stats::Histogram transferLatency;
+};
+
+#endif // __MEM_RUBY_STRUCTURES_SPMDMAENGINE_HH__
@@ -33,6 +33,7 @@
 #include "debug/RubyStats.hh"
 #include "mem/protocol/AccessPermission.hh"
 #include "mem/ruby/system/CacheMemory.hh"
+#include "mem/ruby/system/HeldLineFilter.hh"
 #include "mem/ruby/system/System.hh"
 
 using namespace std;
@@ -59,6 +60,7 @@ CacheMemory::CacheMemory(const Params *p)
     m_cache_size = p->size;
     m_latency = p->latency;
     m_cache_assoc = p->assoc;
+    m_spm_ways = 0;
     m_policy = p->replacement_policy;
     m_start_index_bit = p->start_index_bit;
     m_is_instruction_only_cache = p->is_icache;
@@ -218,7 +220,7 @@ CacheMemory::cacheAvail(const Address& address) const
 
     Index cacheSet = addressToCacheSet(address);
 
-    for (int i = 0; i < m_cache_assoc; i++) {
+    for (int i = 0; i < m_cache_assoc - m_spm_ways; i++) {
         AbstractCacheEntry* entry = m_cache[cacheSet][i];
         if (entry != NULL) {
             if (entry->m_Address == address ||
@@ -244,8 +246,10 @@ CacheMemory::allocate(const Address& address, AbstractCacheEntry* entry)
     // Find the first open slot
     Index cacheSet = addressToCacheSet(address);
     std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
-    for (int i = 0; i < m_cache_assoc; i++) {
+    for (int i = 0; i < m_cache_assoc - m_spm_ways; i++) {
         if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
+            if (set[i])
+                HeldLineFilter::remove(set[i]->m_Address);
             set[i] = entry;  // Init entry
             set[i]->m_Address = address;
             set[i]->m_Permission = AccessPermission_Invalid;
@@ -253,6 +257,7 @@ CacheMemory::allocate(const Address& address, AbstractCacheEntry* entry)
                     address);
             set[i]->m_locked = -1;
             m_tag_index[address] = i;
+            HeldLineFilter::add(address);
 
             m_replacementPolicy_ptr->touch(cacheSet, i, curTick());
 
@@ -274,6 +279,7 @@ CacheMemory::deallocate(const Address& address)
         delete m_cache[cacheSet][loc];
         m_cache[cacheSet][loc] = NULL;
         m_tag_index.erase(address);
+        HeldLineFilter::remove(address);
     }
 }
 
@@ -285,8 +291,57 @@ CacheMemory::cacheProbe(const Address& address) const
     assert(!cacheAvail(address));
 
     Index cacheSet = addressToCacheSet(address);
-    return m_cache[cacheSet][m_replacementPolicy_ptr->getVictim(cacheSet)]->
-        m_Address;
+    int victim = m_replacementPolicy_ptr->getVictim(cacheSet);
+
+    // The policy does not know about reserved ways, fall back to the
+    // least recently touched way that may still hold a line
+    if (victim >= m_cache_assoc - m_spm_ways) {
+        victim = 0;
+        for (int i = 1; i < m_cache_assoc - m_spm_ways; i++) {
+            if (m_replacementPolicy_ptr->getLastAccess(cacheSet, i) <
+                m_replacementPolicy_ptr->getLastAccess(cacheSet, victim)) {
+                victim = i;
+            }
+        }
+    }
+
+    return m_cache[cacheSet][victim]->m_Address;
+}
+
+void
+CacheMemory::setSpmWays(int ways)
+{
+    assert(ways >= 0 && ways < m_cache_assoc);
+    assert(!hasLineInTopWays(ways));
+    DPRINTF(RubyCache, "%d of %d ways reserved for the spm\n", ways,
+            m_cache_assoc);
+    m_spm_ways = ways;
+}
+
+bool
+CacheMemory::hasLineInTopWays(int ways) const
+{
+    for (int i = 0; i < m_cache_num_sets; i++) {
+        for (int j = m_cache_assoc - ways; j < m_cache_assoc; j++) {
+            if (m_cache[i][j] != NULL &&
+                m_cache[i][j]->m_Permission != AccessPermission_NotPresent)
+                return true;
+        }
+    }
+    return false;
+}
+
+Address
+CacheMemory::getLineInTopWays(int ways) const
+{
+    for (int i = 0; i < m_cache_num_sets; i++) {
+        for (int j = m_cache_assoc - ways; j < m_cache_assoc; j++) {
+            if (m_cache[i][j] != NULL &&
+                m_cache[i][j]->m_Permission != AccessPermission_NotPresent)
+                return m_cache[i][j]->m_Address;
+        }
+    }
+    panic("No line left in the top %d ways\n", ways);
 }
 
 // looks an address up in the cache
@@ -91,6 +91,18 @@ class CacheMemory : public SimObject
     const AbstractCacheEntry* lookup(const Address& address) const;
 
     Cycles getLatency() const { return m_latency; }
+    int getAssoc() const { return m_cache_assoc; }
+    int getNumSets() const { return m_cache_num_sets; }
+
+    // Hand the top ways of every set to a scratchpad.  Reserved ways are
+    // never allocated; they must be emptied before they are reserved.
+    void setSpmWays(int ways);
+    int getSpmWays() const { return m_spm_ways; }
+
+    // true if some set still holds a line in one of its top ways
+    bool hasLineInTopWays(int ways) const;
+    // a line held in one of the top ways of some set
+    Address getLineInTopWays(int ways) const;
 
     // Hook for checkpointing the contents of the cache
     void recordCacheContents(int cntrl, CacheRecorder* tr) const;
@@ -165,6 +177,8 @@ class CacheMemory : public SimObject
     int m_cache_num_sets;
     int m_cache_num_set_bits;
     int m_cache_assoc;
+    // number of top ways handed to a scratchpad
+    int m_spm_ways;
     int m_start_index_bit;
     bool m_resource_stalls;
 };
@@ -47,8 +47,12 @@ DirectoryMemory::DirectoryMemory(const Params *p)
     m_size_bytes = p->size;
     m_size_bits = floorLog2(m_size_bytes);
     m_num_entries = 0;
+    m_entries = NULL;
+    m_pages = NULL;
+    m_num_pages = 0;
     m_use_map = p->use_map;
     m_map_levels = p->map_levels;
+    m_use_pages = p->use_pages && !m_use_map;
     m_numa_high_bit = p->numa_high_bit;
 }
 
@@ -60,6 +64,12 @@ DirectoryMemory::init()
     if (m_use_map) {
         m_sparseMemory = new SparseMemory(m_map_levels);
         g_system_ptr->registerSparseMemory(m_sparseMemory);
+    } else if (m_use_pages) {
+        m_num_pages = (m_num_entries + PAGE_ENTRIES - 1) >> PAGE_ENTRIES_BITS;
+        m_pages = new AbstractEntry**[m_num_pages];
+        for (uint64 i = 0; i < m_num_pages; i++)
+            m_pages[i] = NULL;
+        m_ram = g_system_ptr->getMemoryVector();
     } else {
         m_entries = new AbstractEntry*[m_num_entries];
         for (int i = 0; i < m_num_entries; i++)
@@ -87,6 +97,17 @@ DirectoryMemory::~DirectoryMemory()
             }
         }
         delete [] m_entries;
+    } else if (m_pages != NULL) {
+        for (uint64 i = 0; i < m_num_pages; i++) {
+            if (m_pages[i] == NULL)
+                continue;
+            for (uint64 j = 0; j < PAGE_ENTRIES; j++) {
+                if (m_pages[i][j] != NULL)
+                    delete m_pages[i][j];
+            }
+            delete [] m_pages[i];
+        }
+        delete [] m_pages;
     } else if (m_use_map) {
         delete m_sparseMemory;
     }
@@ -132,6 +153,11 @@ DirectoryMemory::lookup(PhysAddress address)
 
     if (m_use_map) {
         return m_sparseMemory->lookup(address);
+    } else if (m_use_pages) {
+        uint64_t idx = mapAddressToLocalIdx(address);
+        assert(idx < m_num_entries);
+        AbstractEntry **page = m_pages[idx >> PAGE_ENTRIES_BITS];
+        return page == NULL ? NULL : page[idx & (PAGE_ENTRIES - 1)];
     } else {
         uint64_t idx = mapAddressToLocalIdx(address);
         assert(idx < m_num_entries);
@@ -149,6 +175,12 @@ DirectoryMemory::allocate(const PhysAddress& address, AbstractEntry* entry)
     if (m_use_map) {
         m_sparseMemory->add(address, entry);
         entry->changePermission(AccessPermission_Read_Write);
+    } else if (m_use_pages) {
+        idx = mapAddressToLocalIdx(address);
+        assert(idx < m_num_entries);
+        entry->getDataBlk().assign(m_ram->getBlockPtr(address));
+        entry->changePermission(AccessPermission_Read_Only);
+        getPage(idx)[idx & (PAGE_ENTRIES - 1)] = entry;
     } else {
         idx = mapAddressToLocalIdx(address);
         assert(idx < m_num_entries);
@@ -160,6 +192,19 @@ DirectoryMemory::allocate(const PhysAddress& address, AbstractEntry* entry)
     return entry;
 }
 
+AbstractEntry **
+DirectoryMemory::getPage(uint64 idx)
+{
+    AbstractEntry **&page = m_pages[idx >> PAGE_ENTRIES_BITS];
+    if (page == NULL) {
+        page = new AbstractEntry*[PAGE_ENTRIES];
+        for (uint64 i = 0; i < PAGE_ENTRIES; i++)
+            page[i] = NULL;
+        m_pages_touched++;
+    }
+    return page;
+}
+
 void
 DirectoryMemory::invalidateBlock(PhysAddress address)
 {
@@ -197,6 +242,12 @@ DirectoryMemory::regStats()
     if (m_use_map) {
         m_sparseMemory->regStats(name());
     }
+
+    m_pages_touched
+        .name(name() + ".pages_touched")
+        .desc("pages of directory entries allocated")
+        .flags(Stats::nozero)
+        ;
 }
 
 void
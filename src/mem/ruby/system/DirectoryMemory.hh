@@ -32,6 +32,7 @@
 #include <iostream>
 #include <string>
 
+#include "base/statistics.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/protocol/DirectoryRequestType.hh"
 #include "mem/ruby/slicc_interface/AbstractEntry.hh"
@@ -72,9 +73,20 @@ class DirectoryMemory : public SimObject
     DirectoryMemory(const DirectoryMemory& obj);
     DirectoryMemory& operator=(const DirectoryMemory& obj);
 
+    // the page holding the entry at local index idx, allocated if absent
+    AbstractEntry **getPage(uint64 idx);
+
   private:
+    // entries per page of the paged implementation
+    static const int PAGE_ENTRIES_BITS = 9;
+    static const uint64 PAGE_ENTRIES = ULL(1) << PAGE_ENTRIES_BITS;
+
     const std::string m_name;
     AbstractEntry **m_entries;
+    // Paged implementation: a root table of pages of entry pointers.  A
+    // page is only allocated when a line in it is first allocated.
+    AbstractEntry ***m_pages;
+    uint64 m_num_pages;
     // int m_size;  // # of memory module blocks this directory is
                     // responsible for
     uint64 m_size_bytes;
@@ -91,6 +103,10 @@ class DirectoryMemory : public SimObject
     SparseMemory* m_sparseMemory;
     bool m_use_map;
     int m_map_levels;
+    bool m_use_pages;
+
+    //! Pages of the paged implementation allocated so far
+    Stats::Scalar m_pages_touched;
 };
 
 inline std::ostream&
@@ -39,6 +39,8 @@ class RubyDirectoryMemory(SimObject):
     size = Param.MemorySize("1GB", "capacity in bytes")
     use_map = Param.Bool(False, "enable sparse memory")
     map_levels = Param.Int(4, "sparse memory map levels")
+    use_pages = Param.Bool(False, "allocate entries a page at a time, "
+                           "on first touch")
     # the default value of the numa high bit is specified in the command line
     # option and must be passed into the directory memory sim object
     numa_high_bit = Param.Int("numa high bit")
@@ -0,0 +1,3 @@
+#include "mem/ruby/system/HeldLineFilter.hh"
+
+uint32_t HeldLineFilter::s_counts[1 << HeldLineFilter::BucketBits];
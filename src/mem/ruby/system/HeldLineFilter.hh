@@ -0,0 +1,55 @@
+#ifndef __MEM_RUBY_SYSTEM_HELDLINEFILTER_HH__
+#define __MEM_RUBY_SYSTEM_HELDLINEFILTER_HH__
+
+#include <cassert>
+
+#include "base/types.hh"
+#include "mem/ruby/common/Address.hh"
+
+/**
+ * Counts, per hash bucket, the cache entries and TBEs that hold a line
+ * hashing to it.  Caches and TBE tables report each line they take and
+ * drop.  A zero count proves that no controller has the line outside
+ * its backing store, which lets functional accesses go straight to the
+ * line's home instead of asking every controller.  Collisions only cost
+ * a trip down the slow path.
+ */
+class HeldLineFilter
+{
+  public:
+    static void
+    add(const Address& line)
+    {
+        s_counts[bucket(line)]++;
+    }
+
+    static void
+    remove(const Address& line)
+    {
+        uint32_t &count = s_counts[bucket(line)];
+        assert(count > 0);
+        count--;
+    }
+
+    static bool
+    mayBeHeld(const Address& line)
+    {
+        return s_counts[bucket(line)] != 0;
+    }
+
+  private:
+    static const int BucketBits = 16;
+
+    static unsigned
+    bucket(const Address& line)
+    {
+        // Line addresses have their low bits clear, so take the high
+        // bits of a multiplicative hash
+        uint64_t h = line.getAddress() * ULL(0x9e3779b97f4a7c15);
+        return h >> (64 - BucketBits);
+    }
+
+    static uint32_t s_counts[1 << BucketBits];
+};
+
+#endif // __MEM_RUBY_SYSTEM_HELDLINEFILTER_HH__
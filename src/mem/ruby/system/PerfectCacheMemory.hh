@@ -32,6 +32,7 @@
 #include "base/hashmap.hh"
 #include "mem/protocol/AccessPermission.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/system/HeldLineFilter.hh"
 
 template<class ENTRY>
 struct PerfectCacheLineState
@@ -129,6 +130,8 @@ PerfectCacheMemory<ENTRY>::allocate(const Address& address)
     PerfectCacheLineState<ENTRY> line_state;
     line_state.m_permission = AccessPermission_Invalid;
     line_state.m_entry = ENTRY();
+    if (!m_map.count(line_address(address)))
+        HeldLineFilter::add(line_address(address));
     m_map[line_address(address)] = line_state;
 }
 
@@ -137,7 +140,8 @@ template<class ENTRY>
 inline void
 PerfectCacheMemory<ENTRY>::deallocate(const Address& address)
 {
-    m_map.erase(line_address(address));
+    if (m_map.erase(line_address(address)))
+        HeldLineFilter::remove(line_address(address));
 }
 
 // Returns with the physical address of the conflicting cache line
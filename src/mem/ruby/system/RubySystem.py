@@ -42,3 +42,7 @@ class RubySystem(ClockedObject):
     stats_filename = Param.String("ruby.stats",
         "file to which ruby dumps its stats")
     no_mem_vec = Param.Bool(False, "do not allocate Ruby's mem vector");
+    sharer_pointers = Param.Int(0, "L1 sharers of a line tracked by id "
+        "before falling back to a coarse vector, 0 for a full bit vector")
+    sharer_vector_bits = Param.Int(0, "bits of the coarse vector a line "
+        "falls back to once its sharer pointers overflow, 0 to broadcast")
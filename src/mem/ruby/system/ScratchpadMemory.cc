@@ -1,15 +1,30 @@
+#include <algorithm>
+#include <cstring>
 
 #include "base/intmath.hh"
+#include "base/misc.hh"
 #include "debug/RubySpm.hh"
 #include "debug/RubySpmTrace.hh"
 #include "debug/RubyResourceStalls.hh"
 #include "debug/RubyStats.hh"
-#include "mem/protocol/AccessPermission.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
+#include "mem/ruby/structures/SpmDMAEngine.hh"
+#include "mem/ruby/system/CacheMemory.hh"
 #include "mem/ruby/system/ScratchpadMemory.hh"
 #include "mem/ruby/system/System.hh"
 
 using namespace std;
 
+map<Addr, ScratchpadMemory::SpmWindow> ScratchpadMemory::s_windows;
+map<Addr, Addr> ScratchpadMemory::s_noncoherent;
+
+static bool
+regionBaseLess(const ScratchpadMemory::SpmRegion& a,
+               const ScratchpadMemory::SpmRegion& b)
+{
+    return a.base < b.base;
+}
+
 ostream&
 operator<<(ostream& out, const ScratchpadMemory& obj)
 {
@@ -25,534 +40,874 @@ RubySpmParams::create()
 }
 
 ScratchpadMemory::ScratchpadMemory(const Params *p)
-    : SimObject(p),
-    dataArray(p->dataArrayBanks, p->dataAccessLatency, p->start_index_bit),
-    tagArray(p->tagArrayBanks, p->tagAccessLatency, p->start_index_bit)
+    : SimObject(p), m_controller(NULL), m_dma(NULL), m_cache(p->cache),
+    m_spm_ways(0),
+    m_last_region(0), m_noncoherent_ranges(p->noncoherent_ranges),
+    m_config_ways(0), m_configs_queued(0), m_configs_applied(0),
+    m_data(NULL), m_num_occupied(0),
+    m_num_banks(p->num_banks), m_ports_per_bank(p->ports_per_bank),
+    m_bank_busy(p->bank_busy_cycles), m_interleave_bits(0),
+    m_interleave(p->bank_interleave), m_word_size(p->word_size),
+    m_read_energy_pj(p->read_energy), m_write_energy_pj(p->write_energy)
 {
-    m_cache_size = p->size;
+    SpmRegion unused = { 0, 0, 0 };
+    m_region_table.resize(p->num_regions, unused);
+    m_spm_size = p->size;
+    m_base_size = p->size;
+    m_window_size = p->window_size == 0 ? p->size : p->window_size;
+    m_base_addr = p->base_addr;
     m_latency = p->latency;
-    m_cache_assoc = p->assoc;
-    m_policy = p->replacement_policy;
-    m_start_index_bit = p->start_index_bit;
-    m_is_instruction_only_cache = p->is_icache;
-    m_resource_stalls = p->resourceStalls;
 }
 
 void
 ScratchpadMemory::init()
 {
-    m_cache_num_sets = (m_cache_size / m_cache_assoc) /
-        RubySystem::getBlockSizeBytes();
-    assert(m_cache_num_sets > 1);
-    m_cache_num_set_bits = floorLog2(m_cache_num_sets);
-    assert(m_cache_num_set_bits > 0);
-
-    if (m_policy == "PSEUDO_LRU")
-        m_replacementPolicy_ptr =
-            new PseudoLRUPolicy(m_cache_num_sets, m_cache_assoc);
-    else if (m_policy == "LRU")
-        m_replacementPolicy_ptr =
-            new LRUPolicy(m_cache_num_sets, m_cache_assoc);
-    else
-        assert(false);
-
-    m_cache.resize(m_cache_num_sets);
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        m_cache[i].resize(m_cache_assoc);
-        for (int j = 0; j < m_cache_assoc; j++) {
-            m_cache[i][j] = NULL;
-        }
+    int block_size = RubySystem::getBlockSizeBytes();
+    m_block_size_bits = floorLog2(block_size);
+
+    if (m_spm_size == 0 || m_spm_size % block_size != 0)
+        fatal("%s: size %d must be a non-zero multiple of the block size\n",
+              name(), m_spm_size);
+    if (m_base_addr % block_size != 0)
+        fatal("%s: base address %#x must be block aligned\n",
+              name(), m_base_addr);
+    if (m_window_size < m_spm_size || m_window_size % block_size != 0)
+        fatal("%s: window size %d must be a multiple of the block size "
+              "no smaller than the spm\n", name(), m_window_size);
+
+    m_num_lines = m_window_size >> m_block_size_bits;
+
+    if (m_num_banks <= 0 || m_ports_per_bank <= 0 || m_bank_busy == 0)
+        fatal("%s: needs at least one bank, one port per bank and a bank "
+              "busy time of one cycle\n", name());
+    if (m_interleave == Enums::word) {
+        if (!isPowerOf2(m_word_size) || m_word_size > block_size)
+            fatal("%s: word size %d must be a power of two no larger than "
+                  "a line\n", name(), m_word_size);
+        m_interleave_bits = floorLog2(m_word_size);
+    } else {
+        m_interleave_bits = m_block_size_bits;
     }
+    m_port_free.resize(m_num_banks * m_ports_per_bank, Cycles(0));
+
+    // Windows may not overlap, or remote accesses would be ambiguous
+    if (overlapsWindow(m_base_addr, m_window_size, NULL, 0))
+        fatal("%s: window [%#x, %#x) overlaps another spm\n", name(),
+              m_base_addr, m_base_addr + m_window_size);
+    addWindow(m_base_addr, m_window_size, this);
+
+    for (int i = 0; i < m_noncoherent_ranges.size(); i++) {
+        addNonCoherentRange(m_noncoherent_ranges[i].start(),
+                            m_noncoherent_ranges[i].size());
+    }
+
+    m_data = new uint8_t[m_window_size];
+    memset(m_data, 0, m_window_size);
+
+    // Point each line's DataBlock at its slice of the backing store so that
+    // the protocol and sequencer can hand the line around without copying.
+    m_blocks.resize(m_num_lines);
+    for (uint64 i = 0; i < m_num_lines; i++) {
+        m_blocks[i].assign(&m_data[i << m_block_size_bits]);
+    }
+    m_occupied.resize(m_num_lines, false);
+
+    DPRINTF(RubySpm, "%s: %d lines mapped at [%#x, %#x), window %#x\n",
+            name(), m_spm_size >> m_block_size_bits, m_base_addr,
+            m_base_addr + m_spm_size, m_base_addr + m_window_size);
 }
 
 ScratchpadMemory::~ScratchpadMemory()
 {
-    if (m_replacementPolicy_ptr != NULL)
-        delete m_replacementPolicy_ptr;
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            delete m_cache[i][j];
-        }
+    SpmControl::unregisterSpm(this);
+
+    removeWindow(m_base_addr, this);
+    for (int i = 0; i < m_regions.size(); i++)
+        removeWindow(m_regions[i].base, this);
+
+    // The DataBlock views do not own their storage
+    m_blocks.clear();
+    delete [] m_data;
+}
+
+bool
+ScratchpadMemory::isInSpm(const Address& address) const
+{
+    physical_address_t addr = address.getAddress();
+    if (addr >= m_base_addr && addr - m_base_addr < m_spm_size)
+        return true;
+    return lookupRegion(addr) != NULL;
+}
+
+bool
+ScratchpadMemory::isRangeInSpm(Addr base, Addr length) const
+{
+    assert(length > 0);
+    if (base >= m_base_addr && base - m_base_addr < m_spm_size)
+        return length <= m_spm_size - (base - m_base_addr);
+    const SpmRegion *r = lookupRegion(base);
+    return r != NULL && length <= r->size - (base - r->base);
+}
+
+bool
+ScratchpadMemory::isRangeInPendingSpm(Addr base, Addr length) const
+{
+    assert(length > 0);
+    uint64 spm_size = pendingSpmSize();
+    if (base >= m_base_addr && base - m_base_addr < spm_size)
+        return length <= spm_size - (base - m_base_addr);
+
+    vector<SpmRegion> table = pendingRegionTable();
+    for (int i = 0; i < table.size(); i++) {
+        const SpmRegion &r = table[i];
+        if (r.size != 0 && base >= r.base && base - r.base < r.size)
+            return length <= r.size - (base - r.base);
     }
+    return false;
 }
 
-// convert a Address to its location in the cache
-Index
-ScratchpadMemory::addressToCacheSet(const Address& address) const
+uint64
+ScratchpadMemory::pendingSpmSize() const
 {
-    assert(address == line_address(address));
-    return address.bitSelect(m_start_index_bit,
-                             m_start_index_bit + m_cache_num_set_bits - 1);
+    if (m_cache == NULL)
+        return m_base_size;
+    return m_base_size +
+        ((uint64)m_config_ways * m_cache->getNumSets() << m_block_size_bits);
 }
 
-// Given a cache index: returns the index of the tag in a set.
-// returns -1 if the tag is not found.
-int
-ScratchpadMemory::findTagInSet(Index cacheSet, const Address& tag) const
+const ScratchpadMemory::SpmRegion*
+ScratchpadMemory::findRegion(Addr addr) const
+{
+    SpmRegion key = { addr, 0, 0 };
+    vector<SpmRegion>::const_iterator it =
+        upper_bound(m_regions.begin(), m_regions.end(), key,
+                    regionBaseLess);
+    if (it == m_regions.begin())
+        return NULL;
+    --it;
+    if (addr - it->base >= it->size)
+        return NULL;
+    m_last_region = it - m_regions.begin();
+    return &(*it);
+}
+
+const ScratchpadMemory::SpmRegion&
+ScratchpadMemory::getRegion(int index) const
+{
+    assert(index >= 0 && index < m_region_table.size());
+    return m_region_table[index];
+}
+
+void
+ScratchpadMemory::setController(AbstractController *ctrl)
+{
+    m_controller = ctrl;
+    m_owner = ctrl->getMachineID();
+    // L1 controllers are numbered after the cpu they serve
+    SpmControl::registerSpm(m_owner.getNum(), this);
+}
+
+void
+ScratchpadMemory::setDMAEngine(SpmDMAEngine *dma)
 {
-    assert(tag == line_address(tag));
-    // search the set for the tags
-    m5::hash_map<Address, int>::const_iterator it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
-    return -1; // Not found
+    if (m_dma != NULL && m_dma != dma)
+        fatal("%s: already served by %s\n", name(), m_dma->name());
+    m_dma = dma;
 }
 
-// Given a cache index: returns the index of the tag in a set.
-// returns -1 if the tag is not found.
 int
-ScratchpadMemory::findTagInSetIgnorePermissions(Index cacheSet,
-                                           const Address& tag) const
+ScratchpadMemory::startDma(Addr src, Addr dst, Addr length, Addr stride,
+                           bool move_in)
 {
-    assert(tag == line_address(tag));
-    // search the set for the tags
-    m5::hash_map<Address, int>::const_iterator it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
-    return -1; // Not found
+    if (m_dma == NULL) {
+        warn("%s: no dma engine, ignoring transfer\n", name());
+        return -1;
+    }
+    return m_dma->startTransfer(src, dst, length, stride, move_in);
 }
 
 bool
-ScratchpadMemory::tryCacheAccess(const Address& address, RubyRequestType type,
-                            DataBlock*& data_ptr)
+ScratchpadMemory::waitDma(int id, Event *wakeup)
 {
-    assert(address == line_address(address));
-    DPRINTF(RubySpm, "address: %s\n", address);
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    if (loc != -1) {
-        // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
-        m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
-        data_ptr = &(entry->getDataBlk());
-
-        if (entry->m_Permission == AccessPermission_Read_Write) {
-            return true;
-        }
-        if ((entry->m_Permission == AccessPermission_Read_Only) &&
-            (type == RubyRequestType_LD || type == RubyRequestType_IFETCH)) {
-            return true;
-        }
-        // The line must not be accessible
+    if (m_dma == NULL || !m_dma->isValidId(id)) {
+        // Nothing will ever complete, so do not leave the caller waiting
+        warn("%s: waiting on unknown transfer %d\n", name(), id);
+        return true;
     }
-    data_ptr = NULL;
-    return false;
+    if (wakeup == NULL)
+        return m_dma->isComplete(id);
+    return !m_dma->setCompletion(id, wakeup);
 }
 
 bool
-ScratchpadMemory::testCacheAccess(const Address& address, RubyRequestType type,
-                             DataBlock*& data_ptr)
+ScratchpadMemory::partition(int ways)
 {
-    assert(address == line_address(address));
-    DPRINTF(RubySpm, "address: %s\n", address);
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
+    if (m_cache == NULL || m_controller == NULL) {
+        warn("%s: no cache to borrow ways from, ignoring SPMCONFIG\n",
+             name());
+        return false;
+    }
 
-    if (loc != -1) {
-        // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
-        m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
-        data_ptr = &(entry->getDataBlk());
+    uint64 way_bytes = (uint64)m_cache->getNumSets() << m_block_size_bits;
+    uint64 spm_size = m_base_size + ways * way_bytes;
+    if (ways < 0 || ways >= m_cache->getAssoc() ||
+        spm_size > m_window_size) {
+        warn("%s: cannot hand %d ways to the spm, the cache has %d ways "
+             "and the window %d bytes\n", name(), ways,
+             m_cache->getAssoc(), m_window_size);
+        return false;
+    }
 
-        return m_cache[cacheSet][loc]->m_Permission !=
-            AccessPermission_NotPresent;
+    // Shrinking may not strand a mapped region
+    for (int i = 0; i < m_region_table.size(); i++) {
+        const SpmRegion &r = m_region_table[i];
+        if (r.size != 0 && r.offset + r.size > spm_size) {
+            warn("%s: cannot shrink to %d bytes, region %d is mapped up "
+                 "to offset %#x\n", name(), spm_size, i,
+                 r.offset + r.size);
+            return false;
+        }
+    }
+    for (deque<SpmConfig>::const_iterator it = m_pending.begin();
+         it != m_pending.end(); ++it) {
+        if (it->index >= 0 &&
+            it->region.offset + it->region.size > spm_size) {
+            warn("%s: cannot shrink to %d bytes, a pending mapping of "
+                 "region %d reaches offset %#x\n", name(), spm_size,
+                 it->index, it->region.offset + it->region.size);
+            return false;
+        }
     }
 
-    data_ptr = NULL;
-    return false;
+    DPRINTF(RubySpm, "%s: SPMCONFIG %d ways\n", name(), ways);
+
+    SpmConfig config;
+    config.index = -1;
+    m_pending.push_back(config);
+    m_configs_queued++;
+    m_config_ways = ways;
+
+    // The request carries the way count in its size field
+    RubyRequest *msg = new RubyRequest(curTick(), m_base_addr, NULL, ways, 0,
+                                       RubyRequestType_SPMCONFIG,
+                                       RubyAccessMode_Supervisor, NULL);
+    m_controller->getMandatoryQueue()->enqueue(msg, Cycles(1));
+    return true;
 }
 
-// tests to see if an address is present in the cache
 bool
-ScratchpadMemory::isTagPresent(const Address& address) const
+ScratchpadMemory::setRegion(int index, Addr base, Addr size, Addr offset)
 {
-    assert(address == line_address(address));
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-
-    if (loc == -1) {
-        // We didn't find the tag
-        DPRINTF(RubySpm, "No tag match for address: %s\n", address);
+    if (m_controller == NULL) {
+        warn("%s: no controller, ignoring SPMCONFIG\n", name());
         return false;
     }
-    DPRINTF(RubySpm, "address: %s found\n", address);
+
+    SpmRegion region = { base, size, offset };
+    if (!checkRegion(index, region, pendingSpmSize(), false))
+        return false;
+
+    DPRINTF(RubySpm, "%s: SPMCONFIG region %d [%#x, %#x) -> %#x\n",
+            name(), index, base, base + size, offset);
+
+    SpmConfig config;
+    config.index = index;
+    config.region = region;
+    m_pending.push_back(config);
+    m_configs_queued++;
+
+    // Mapping leaves the partition alone, so the controller finds no
+    // lines to replace
+    RubyRequest *msg = new RubyRequest(curTick(), m_base_addr, NULL,
+                                       m_config_ways, 0,
+                                       RubyRequestType_SPMCONFIG,
+                                       RubyAccessMode_Supervisor, NULL);
+    m_controller->getMandatoryQueue()->enqueue(msg, Cycles(1));
     return true;
 }
 
-// Returns true if there is:
-//   a) a tag match on this address or there is
-//   b) an unused line in the same cache "way"
-bool
-ScratchpadMemory::cacheAvail(const Address& address) const
+int
+ScratchpadMemory::mapRegion(Addr base, Addr size, Addr offset)
 {
-    assert(address == line_address(address));
+    if (size == 0) {
+        warn("%s: cannot map an empty region\n", name());
+        return -1;
+    }
 
-    Index cacheSet = addressToCacheSet(address);
-
-    for (int i = 0; i < m_cache_assoc; i++) {
-        AbstractCacheEntry* entry = m_cache[cacheSet][i];
-        if (entry != NULL) {
-            if (entry->m_Address == address ||
-                entry->m_Permission == AccessPermission_NotPresent) {
-                // Already in the cache or we found an empty entry
-                return true;
-            }
-        } else {
-            return true;
-        }
+    vector<SpmRegion> table = pendingRegionTable();
+    for (int i = 0; i < table.size(); i++) {
+        if (table[i].size == 0)
+            return setRegion(i, base, size, offset) ? i : -1;
     }
-    return false;
+    warn("%s: cannot map [%#x, %#x), all %d regions are in use\n", name(),
+         base, base + size, table.size());
+    return -1;
 }
 
-AbstractCacheEntry*
-ScratchpadMemory::allocate(const Address& address, AbstractCacheEntry* entry)
+bool
+ScratchpadMemory::unmapRegion(Addr base)
 {
-    assert(address == line_address(address));
-    assert(!isTagPresent(address));
-    assert(cacheAvail(address));
-    DPRINTF(RubySpm, "address: %s\n", address);
-
-    // Find the first open slot
-    Index cacheSet = addressToCacheSet(address);
-    std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
-    for (int i = 0; i < m_cache_assoc; i++) {
-        if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
-            set[i] = entry;  // Init entry
-            set[i]->m_Address = address;
-            set[i]->m_Permission = AccessPermission_Invalid;
-            DPRINTF(RubySpm, "Allocate clearing lock for addr: %x\n",
-                    address);
-            set[i]->m_locked = -1;
-            m_tag_index[address] = i;
-
-            m_replacementPolicy_ptr->touch(cacheSet, i, curTick());
-
-            return entry;
-        }
+    vector<SpmRegion> table = pendingRegionTable();
+    for (int i = 0; i < table.size(); i++) {
+        if (table[i].size != 0 && table[i].base == base)
+            return setRegion(i, 0, 0, 0);
     }
-    panic("Allocate didn't find an available entry");
+    warn("%s: no region is mapped at %#x\n", name(), base);
+    return false;
 }
 
-void
-ScratchpadMemory::deallocate(const Address& address)
+vector<ScratchpadMemory::SpmRegion>
+ScratchpadMemory::pendingRegionTable() const
 {
-    assert(address == line_address(address));
-    assert(isTagPresent(address));
-    DPRINTF(RubySpm, "address: %s\n", address);
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    if (loc != -1) {
-        delete m_cache[cacheSet][loc];
-        m_cache[cacheSet][loc] = NULL;
-        m_tag_index.erase(address);
+    vector<SpmRegion> table = m_region_table;
+    for (deque<SpmConfig>::const_iterator it = m_pending.begin();
+         it != m_pending.end(); ++it) {
+        if (it->index >= 0)
+            table[it->index] = it->region;
     }
+    return table;
 }
 
-// Returns with the physical address of the conflicting cache line
-Address
-ScratchpadMemory::cacheProbe(const Address& address) const
+bool
+ScratchpadMemory::checkRegion(int index, const SpmRegion& region,
+                              uint64 spm_size, bool quiet) const
 {
-    assert(address == line_address(address));
-    assert(!cacheAvail(address));
+    uint64 block_size = 1 << m_block_size_bits;
+    if (index < 0 || index >= m_region_table.size()) {
+        if (!quiet)
+            warn("%s: no region %d, the table has %d entries\n", name(),
+                 index, m_region_table.size());
+        return false;
+    }
+
+    // A size of zero unmaps the entry
+    if (region.size == 0)
+        return true;
 
-    Index cacheSet = addressToCacheSet(address);
-    return m_cache[cacheSet][m_replacementPolicy_ptr->getVictim(cacheSet)]->
-        m_Address;
+    if (region.base % block_size != 0 || region.size % block_size != 0 ||
+        region.offset % block_size != 0 ||
+        region.base + region.size < region.base ||
+        region.offset + region.size > spm_size) {
+        if (!quiet)
+            warn("%s: cannot map [%#x, %#x) at offset %#x, the range must "
+                 "be line aligned and fit in %d bytes\n", name(),
+                 region.base, region.base + region.size, region.offset,
+                 spm_size);
+        return false;
+    }
+
+    // Remapping an entry may reuse its own range
+    Addr old_base = m_region_table[index].size != 0 ?
+        m_region_table[index].base : 0;
+    const ScratchpadMemory *self = m_region_table[index].size != 0 ?
+        this : NULL;
+    if (overlapsWindow(region.base, region.size, self, old_base)) {
+        if (!quiet)
+            warn("%s: cannot map [%#x, %#x), it overlaps a mapped spm "
+                 "range\n", name(), region.base,
+                 region.base + region.size);
+        return false;
+    }
+    return true;
 }
 
-// looks an address up in the cache
-// TODO 更改为可以返回参数地址所在的block
-AbstractCacheEntry*
-ScratchpadMemory::lookup(const Address& address)
+void
+ScratchpadMemory::applyConfig(int ways)
 {
-    assert(address == line_address(address));
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    if(loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    assert(!m_pending.empty());
+    SpmConfig config = m_pending.front();
+    m_pending.pop_front();
+    m_configs_applied++;
+
+    if (config.index < 0) {
+        setPartition(ways);
+    } else if (checkRegion(config.index, config.region, m_spm_size, true)) {
+        applyRegion(config.index, config.region);
+    } else {
+        // Another spm claimed the range while the request was queued
+        warn("%s: dropping mapping of region %d, [%#x, %#x) is no longer "
+             "free\n", name(), config.index, config.region.base,
+             config.region.base + config.region.size);
+    }
+
+    // Transfers queued behind the request may go ahead now
+    if (m_dma != NULL)
+        m_dma->configApplied();
 }
 
-// looks an address up in the cache
-const AbstractCacheEntry*
-ScratchpadMemory::lookup(const Address& address) const
+void
+ScratchpadMemory::setPartition(int ways)
 {
-    assert(address == line_address(address));
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    if(loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    assert(m_cache != NULL);
+    m_cache->setSpmWays(ways);
+    m_spm_ways = ways;
+    m_spm_size = m_base_size +
+        ((uint64)ways * m_cache->getNumSets() << m_block_size_bits);
+    assert(m_spm_size <= m_window_size);
+
+    // Lines past the new size are left in the backing store; software
+    // must move them out before giving the ways back
+    DPRINTF(RubySpm, "%s: %d ways borrowed, [%#x, %#x) mapped\n", name(),
+            ways, m_base_addr, m_base_addr + m_spm_size);
 }
 
-// Sets the most recently used bit for a cache block
 void
-ScratchpadMemory::setMRU(const Address& address)
+ScratchpadMemory::applyRegion(int index, const SpmRegion& region)
 {
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-
-    if(loc != -1)
-        m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
+    SpmRegion &entry = m_region_table[index];
+    if (entry.size != 0)
+        removeWindow(entry.base, this);
+    entry = region;
+    if (entry.size != 0)
+        addWindow(entry.base, entry.size, this);
+    sortRegions();
+
+    DPRINTF(RubySpm, "%s: region %d [%#x, %#x) -> %#x, %d regions "
+            "mapped\n", name(), index, entry.base, entry.base + entry.size,
+            entry.offset, m_regions.size());
 }
 
 void
-ScratchpadMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
-{
-    uint64 warmedUpBlocks = 0;
-    uint64 totalBlocks M5_VAR_USED = (uint64)m_cache_num_sets
-                                                  * (uint64)m_cache_assoc;
-
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
-                AccessPermission perm = m_cache[i][j]->m_Permission;
-                RubyRequestType request_type = RubyRequestType_NULL;
-                if (perm == AccessPermission_Read_Only) {
-                    if (m_is_instruction_only_cache) {
-                        request_type = RubyRequestType_IFETCH;
-                    } else {
-                        request_type = RubyRequestType_LD;
-                    }
-                } else if (perm == AccessPermission_Read_Write) {
-                    request_type = RubyRequestType_ST;
-                }
-
-                if (request_type != RubyRequestType_NULL) {
-                    tr->addRecord(cntrl, m_cache[i][j]->m_Address.getAddress(),
-                                  0, request_type,
-                                  m_replacementPolicy_ptr->getLastAccess(i, j),
-                                  m_cache[i][j]->getDataBlk());
-                    warmedUpBlocks++;
-                }
-            }
-        }
+ScratchpadMemory::sortRegions()
+{
+    m_regions.clear();
+    for (int i = 0; i < m_region_table.size(); i++) {
+        if (m_region_table[i].size != 0)
+            m_regions.push_back(m_region_table[i]);
     }
-
-    DPRINTF(RubySpmTrace, "%s: %lli blocks of %lli total blocks"
-            "recorded %.2f%% \n", name().c_str(), warmedUpBlocks,
-            (uint64)m_cache_num_sets * (uint64)m_cache_assoc,
-            (float(warmedUpBlocks)/float(totalBlocks))*100.0);
+    sort(m_regions.begin(), m_regions.end(), regionBaseLess);
+    m_last_region = 0;
 }
 
-void
-ScratchpadMemory::print(ostream& out) const
+bool
+ScratchpadMemory::overlapsWindow(Addr base, Addr size,
+                                 const ScratchpadMemory *spm, Addr spm_base)
 {
-    out << "Cache dump: " << m_cache_name << endl;
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
-                out << "  Index: " << i
-                    << " way: " << j
-                    << " entry: " << *m_cache[i][j] << endl;
-            } else {
-                out << "  Index: " << i
-                    << " way: " << j
-                    << " entry: NULL" << endl;
-            }
-        }
+    // Windows are disjoint, so only the last one starting below the end
+    // of the range can reach into it
+    map<Addr, SpmWindow>::const_iterator it =
+        s_windows.lower_bound(base + size);
+    while (it != s_windows.begin()) {
+        --it;
+        if (it->first + it->second.size <= base)
+            return false;
+        if (it->second.spm != spm || it->first != spm_base)
+            return true;
     }
+    return false;
 }
 
 void
-ScratchpadMemory::printData(ostream& out) const
+ScratchpadMemory::addWindow(Addr base, Addr size, ScratchpadMemory *spm)
 {
-    out << "printData() not supported" << endl;
+    SpmWindow window = { size, spm };
+    s_windows[base] = window;
 }
 
 void
-ScratchpadMemory::setLocked(const Address& address, int context)
+ScratchpadMemory::removeWindow(Addr base, const ScratchpadMemory *spm)
 {
-    DPRINTF(RubySpm, "Setting Lock for addr: %x to %d\n", address, context);
-    assert(address == line_address(address));
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    assert(loc != -1);
-    m_cache[cacheSet][loc]->m_locked = context;
+    map<Addr, SpmWindow>::iterator it = s_windows.find(base);
+    if (it != s_windows.end() && it->second.spm == spm)
+        s_windows.erase(it);
+}
+
+ScratchpadMemory*
+ScratchpadMemory::lookupWindow(const Address& address)
+{
+    Addr addr = address.getAddress();
+    map<Addr, SpmWindow>::iterator it = s_windows.upper_bound(addr);
+    if (it == s_windows.begin())
+        return NULL;
+    --it;
+    if (addr - it->first >= it->second.size)
+        return NULL;
+    return it->second.spm->isInSpm(address) ? it->second.spm : NULL;
 }
 
 void
-ScratchpadMemory::clearLocked(const Address& address)
+ScratchpadMemory::addNonCoherentRange(Addr base, Addr size)
 {
-    DPRINTF(RubySpm, "Clear Lock for addr: %x\n", address);
-    assert(address == line_address(address));
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    assert(loc != -1);
-    m_cache[cacheSet][loc]->m_locked = -1;
+    int block_size = RubySystem::getBlockSizeBytes();
+    if (size == 0 || base % block_size != 0 || size % block_size != 0)
+        fatal("%s: non-coherent range [%#x, %#x) must be made of whole "
+              "lines\n", name(), base, base + size);
+    if (overlapsWindow(base, size, NULL, 0))
+        fatal("%s: non-coherent range [%#x, %#x) overlaps an spm window\n",
+              name(), base, base + size);
+
+    // Every spm is usually handed the same list
+    map<Addr, Addr>::iterator it = s_noncoherent.find(base);
+    if (it != s_noncoherent.end() && it->second == size)
+        return;
+
+    it = s_noncoherent.lower_bound(base + size);
+    if (it != s_noncoherent.begin()) {
+        --it;
+        if (it->first + it->second > base)
+            fatal("%s: non-coherent range [%#x, %#x) overlaps [%#x, %#x)\n",
+                  name(), base, base + size, it->first,
+                  it->first + it->second);
+    }
+    s_noncoherent[base] = size;
+
+    DPRINTF(RubySpm, "%s: [%#x, %#x) is non-coherent\n", name(), base,
+            base + size);
 }
 
 bool
-ScratchpadMemory::isLocked(const Address& address, int context)
+ScratchpadMemory::isNonCoherent(const Address& address)
+{
+    Addr addr = address.getAddress();
+    map<Addr, Addr>::const_iterator it = s_noncoherent.upper_bound(addr);
+    if (it == s_noncoherent.begin())
+        return false;
+    --it;
+    return addr - it->first < it->second;
+}
+
+bool
+isNonCoherentSpmLine(const Address& addr)
+{
+    return ScratchpadMemory::isNonCoherent(addr);
+}
+
+bool
+ScratchpadMemory::isInRemoteSpm(const Address& address) const
+{
+    ScratchpadMemory *spm = lookupWindow(address);
+    return spm != NULL && spm != this;
+}
+
+MachineID
+ScratchpadMemory::getRemoteOwner(const Address& address) const
+{
+    ScratchpadMemory *spm = lookupWindow(address);
+    assert(spm != NULL && spm != this);
+    return spm->getOwner();
+}
+
+DataBlock&
+ScratchpadMemory::getDataBlock(const Address& address)
 {
     assert(address == line_address(address));
-    Index cacheSet = addressToCacheSet(address);
-    int loc = findTagInSet(cacheSet, address);
-    assert(loc != -1);
-    DPRINTF(RubySpm, "Testing Lock for addr: %llx cur %d con %d\n",
-            address, m_cache[cacheSet][loc]->m_locked, context);
-    return m_cache[cacheSet][loc]->m_locked == context;
+    return m_blocks[addressToLine(address)];
+}
+
+const DataBlock&
+ScratchpadMemory::getDataBlock(const Address& address) const
+{
+    assert(address == line_address(address));
+    return m_blocks[addressToLine(address)];
 }
 
 void
-ScratchpadMemory::regStats()
+ScratchpadMemory::readSpmData(const Address& address,
+                              DataBlock& datablock) const
 {
-    m_demand_hits
-        .name(name() + ".demand_hits")
-        .desc("Number of cache demand hits")
-        ;
+    DPRINTF(RubySpm, "read address: %s\n", address);
+    datablock = getDataBlock(address);
+}
 
-    m_demand_misses
-        .name(name() + ".demand_misses")
-        .desc("Number of cache demand misses")
-        ;
+void
+ScratchpadMemory::writeSpmData(const Address& address,
+                               const DataBlock& datablock)
+{
+    DPRINTF(RubySpm, "write address: %s\n", address);
+    getDataBlock(address) = datablock;
+}
 
-    m_demand_accesses
-        .name(name() + ".demand_accesses")
-        .desc("Number of cache demand accesses")
-        ;
+void
+ScratchpadMemory::serialize(ostream &os)
+{
+    if (!m_pending.empty()) {
+        warn("%s: %d SPMCONFIG requests still queued are not "
+             "checkpointed\n", name(), m_pending.size());
+    }
 
-    m_demand_accesses = m_demand_hits + m_demand_misses;
+    // The whole window is saved, lines past the current size included,
+    // since software may grow the spm again and expect them back
+    uint64 data_size = m_window_size;
+    uint8_t *raw_data = new uint8_t[data_size];
+    memcpy(raw_data, m_data, data_size);
+    string data_file = name() + ".data.gz";
+    RubySystem::writeCompressedTrace(raw_data, data_file, data_size);
+
+    SERIALIZE_SCALAR(data_file);
+    SERIALIZE_SCALAR(data_size);
+    paramOut(os, "partition_ways", m_spm_ways);
+
+    vector<Addr> region_base, region_size, region_offset;
+    for (int i = 0; i < m_region_table.size(); i++) {
+        region_base.push_back(m_region_table[i].base);
+        region_size.push_back(m_region_table[i].size);
+        region_offset.push_back(m_region_table[i].offset);
+    }
+    arrayParamOut(os, "region_base", region_base);
+    arrayParamOut(os, "region_size", region_size);
+    arrayParamOut(os, "region_offset", region_offset);
 
-    m_sw_prefetches
-        .name(name() + ".total_sw_prefetches")
-        .desc("Number of software prefetches")
-        .flags(Stats::nozero)
-        ;
+    DPRINTF(RubySpmTrace, "%s: checkpointed %d bytes, %d ways, %d "
+            "regions\n", name(), data_size, m_spm_ways, m_regions.size());
+}
 
-    m_hw_prefetches
-        .name(name() + ".total_hw_prefetches")
-        .desc("Number of hardware prefetches")
-        .flags(Stats::nozero)
-        ;
+void
+ScratchpadMemory::unserialize(Checkpoint *cp, const string &section)
+{
+    string data_file;
+    uint64 data_size = 0;
+    UNSERIALIZE_SCALAR(data_file);
+    UNSERIALIZE_SCALAR(data_size);
+    if (data_size != m_window_size) {
+        fatal("%s: checkpoint holds a %d byte window, this spm has %d\n",
+              name(), data_size, m_window_size);
+    }
 
-    m_prefetches
-        .name(name() + ".total_prefetches")
-        .desc("Number of prefetches")
-        .flags(Stats::nozero)
-        ;
+    uint8_t *raw_data = NULL;
+    RubySystem::readCompressedTrace(cp->cptDir + "/" + data_file, raw_data,
+                                    data_size);
+    memcpy(m_data, raw_data, data_size);
+    delete [] raw_data;
+
+    int ways = 0;
+    paramIn(cp, section, "partition_ways", ways);
+    if (ways != 0) {
+        if (m_cache == NULL)
+            fatal("%s: checkpoint borrows %d ways but there is no cache\n",
+                  name(), ways);
+        setPartition(ways);
+    }
+    m_config_ways = ways;
+
+    vector<Addr> region_base, region_size, region_offset;
+    arrayParamIn(cp, section, "region_base", region_base);
+    arrayParamIn(cp, section, "region_size", region_size);
+    arrayParamIn(cp, section, "region_offset", region_offset);
+    if (region_base.size() > m_region_table.size()) {
+        fatal("%s: checkpoint has %d regions, the table holds %d\n",
+              name(), region_base.size(), m_region_table.size());
+    }
+    for (int i = 0; i < region_base.size(); i++) {
+        SpmRegion region = { region_base[i], region_size[i],
+                             region_offset[i] };
+        if (!checkRegion(i, region, m_spm_size, true)) {
+            fatal("%s: cannot restore region %d [%#x, %#x)\n", name(), i,
+                  region.base, region.base + region.size);
+        }
+        applyRegion(i, region);
+    }
 
-    m_prefetches = m_sw_prefetches + m_hw_prefetches;
+    DPRINTF(RubySpmTrace, "%s: restored %d bytes, %d ways, %d regions\n",
+            name(), data_size, m_spm_ways, m_regions.size());
+}
 
-    m_accessModeType
-        .init(RubyRequestType_NUM)
-        .name(name() + ".access_mode")
-        .flags(Stats::pdf | Stats::total)
-        ;
-    for (int i = 0; i < RubyAccessMode_NUM; i++) {
-        m_accessModeType
-            .subname(i, RubyAccessMode_to_string(RubyAccessMode(i)))
-            .flags(Stats::nozero)
-            ;
+void
+ScratchpadMemory::print(ostream& out) const
+{
+    out << "SPM dump: " << name() << " [" << hex << m_base_addr << ", "
+        << m_base_addr + m_spm_size << dec << ")" << endl;
+    for (int i = 0; i < m_region_table.size(); i++) {
+        const SpmRegion &r = m_region_table[i];
+        if (r.size != 0) {
+            out << "  Region: " << i << " [" << hex << r.base << ", "
+                << r.base + r.size << ") -> " << r.offset << dec << endl;
+        }
     }
+}
 
-    numDataArrayReads
-        .name(name() + ".num_data_array_reads")
-        .desc("number of data array reads")
-        .flags(Stats::nozero)
-        ;
+void
+ScratchpadMemory::printData(ostream& out) const
+{
+    for (uint64 i = 0; i < m_num_lines; i++) {
+        out << "  Line: " << i << " addr: " << hex
+            << m_base_addr + (i << m_block_size_bits) << dec
+            << " data: " << m_blocks[i] << endl;
+    }
+}
 
-    numDataArrayWrites
-        .name(name() + ".num_data_array_writes")
-        .desc("number of data array writes")
-        .flags(Stats::nozero)
+void
+ScratchpadMemory::regStats()
+{
+    m_accesses
+        .init(SpmAccessType_NUM)
+        .name(name() + ".accesses")
+        .desc("number of spm accesses")
+        .flags(Stats::total)
         ;
 
-    numTagArrayReads
-        .name(name() + ".num_tag_array_reads")
-        .desc("number of tag array reads")
-        .flags(Stats::nozero)
+    m_bytes
+        .init(SpmAccessType_NUM)
+        .name(name() + ".bytes")
+        .desc("number of bytes read from or written to the spm")
+        .flags(Stats::total)
         ;
 
-    numTagArrayWrites
-        .name(name() + ".num_tag_array_writes")
-        .desc("number of tag array writes")
-        .flags(Stats::nozero)
+    for (int i = 0; i < SpmAccessType_NUM; i++) {
+        string type = SpmAccessType_to_string(SpmAccessType(i));
+        m_accesses.subname(i, type);
+        m_bytes.subname(i, type);
+    }
+
+    m_bank_conflict_cycles
+        .init(m_num_banks)
+        .name(name() + ".bank_conflict_cycles")
+        .desc("cycles requests waited on a busy bank")
+        .flags(Stats::nozero | Stats::total)
         ;
 
-    numTagArrayStalls
-        .name(name() + ".num_tag_array_stalls")
-        .desc("number of stalls caused by tag array")
-        .flags(Stats::nozero)
+    m_occupancy_peak
+        .name(name() + ".occupancy_peak")
+        .desc("most bytes holding data at once")
         ;
 
-    numDataArrayStalls
-        .name(name() + ".num_data_array_stalls")
-        .desc("number of stalls caused by data array")
-        .flags(Stats::nozero)
+    m_read_energy
+        .name(name() + ".read_energy")
+        .desc("dynamic energy of reads (pJ)")
+        ;
+    m_read_energy = m_read_energy_pj *
+        (m_accesses[SpmAccessType_LocalRead] +
+         m_accesses[SpmAccessType_RemoteRead] +
+         m_accesses[SpmAccessType_DmaOut]);
+
+    m_write_energy
+        .name(name() + ".write_energy")
+        .desc("dynamic energy of writes (pJ)")
+        ;
+    m_write_energy = m_write_energy_pj *
+        (m_accesses[SpmAccessType_LocalWrite] +
+         m_accesses[SpmAccessType_RemoteWrite] +
+         m_accesses[SpmAccessType_DmaIn]);
+
+    m_dynamic_energy
+        .name(name() + ".dynamic_energy")
+        .desc("dynamic energy of all accesses (pJ)")
         ;
+    m_dynamic_energy = m_read_energy + m_write_energy;
 }
 
 void
-ScratchpadMemory::recordRequestType(CacheRequestType requestType)
+ScratchpadMemory::recordAccess(SpmAccessType type, const Address& address,
+                               int bytes)
 {
-    DPRINTF(RubyStats, "Recorded statistic: %s\n",
-            CacheRequestType_to_string(requestType));
-    switch(requestType) {
-    case CacheRequestType_DataArrayRead:
-        numDataArrayReads++;
-        return;
-    case CacheRequestType_DataArrayWrite:
-        numDataArrayWrites++;
-        return;
-    case CacheRequestType_TagArrayRead:
-        numTagArrayReads++;
-        return;
-    case CacheRequestType_TagArrayWrite:
-        numTagArrayWrites++;
-        return;
-    default:
-        warn("ScratchpadMemory access_type not found: %s",
-             CacheRequestType_to_string(requestType));
+    DPRINTF(RubyStats, "Recorded statistic: %s %d bytes at %s\n",
+            SpmAccessType_to_string(type), bytes, address);
+    m_accesses[type]++;
+    m_bytes[type] += bytes;
+
+    uint64 line = addressToLine(address);
+    if (type == SpmAccessType_DmaOut) {
+        if (m_occupied[line]) {
+            m_occupied[line] = false;
+            m_num_occupied--;
+        }
+    } else if (type != SpmAccessType_LocalRead &&
+               type != SpmAccessType_RemoteRead && !m_occupied[line]) {
+        m_occupied[line] = true;
+        m_num_occupied++;
+        Counter occupancy = m_num_occupied << m_block_size_bits;
+        if (occupancy > m_occupancy_peak.value())
+            m_occupancy_peak = occupancy;
     }
 }
 
-bool
-ScratchpadMemory::checkResourceAvailable(CacheResourceType res, Address addr)
+void
+ScratchpadMemory::recordLineAccess(SpmAccessType type,
+                                   const Address& address)
 {
-    if (!m_resource_stalls) {
-        return true;
+    recordAccess(type, address, 1 << m_block_size_bits);
+}
+
+int
+ScratchpadMemory::numBanksOf(uint64 offset, int bytes) const
+{
+    assert(bytes > 0);
+    uint64 first = offset >> m_interleave_bits;
+    uint64 last = (offset + bytes - 1) >> m_interleave_bits;
+    // Past num_banks units the access wraps onto banks it already holds
+    return std::min<uint64>(last - first + 1, m_num_banks);
+}
+
+int
+ScratchpadMemory::earliestPort(int bank) const
+{
+    int base = bank * m_ports_per_bank;
+    int port = base;
+    for (int p = base + 1; p < base + m_ports_per_bank; p++) {
+        if (m_port_free[p] < m_port_free[port])
+            port = p;
     }
+    return port;
+}
 
-    if (res == CacheResourceType_TagArray) {
-        if (tagArray.tryAccess(addressToCacheSet(addr))) return true;
-        else {
-            DPRINTF(RubyResourceStalls,
-                    "Tag array stall on addr %s in set %d\n",
-                    addr, addressToCacheSet(addr));
-            numTagArrayStalls++;
-            return false;
-        }
-    } else if (res == CacheResourceType_DataArray) {
-        if (dataArray.tryAccess(addressToCacheSet(addr))) return true;
-        else {
-            DPRINTF(RubyResourceStalls,
-                    "Data array stall on addr %s in set %d\n",
-                    addr, addressToCacheSet(addr));
-            numDataArrayStalls++;
-            return false;
-        }
-    } else {
-        assert(false);
-        return true;
+Cycles
+ScratchpadMemory::bankAccess(const Address& address, int bytes)
+{
+    assert(m_controller != NULL);
+    Cycles now = m_controller->curCycle();
+    uint64 offset = addressToOffset(address);
+    int first = firstBankOf(offset);
+    int num_banks = numBanksOf(offset, bytes);
+
+    // Take the earliest free port of each bank; the access starts once
+    // all of them are free
+    Cycles start = now;
+    for (int i = 0; i < num_banks; i++) {
+        int port = earliestPort((first + i) % m_num_banks);
+        if (m_port_free[port] > start)
+            start = m_port_free[port];
+    }
+
+    // The banks are distinct, so claiming one port leaves the earliest
+    // port of the others as it was
+    for (int i = 0; i < num_banks; i++) {
+        int bank = (first + i) % m_num_banks;
+        int port = earliestPort(bank);
+        if (m_port_free[port] > now)
+            m_bank_conflict_cycles[bank] += m_port_free[port] - now;
+        m_port_free[port] = Cycles(start + m_bank_busy);
+    }
+
+    if (start > now) {
+        DPRINTF(RubyResourceStalls, "%s: %s waits %d cycles for a bank\n",
+                name(), address, start - now);
     }
+    return Cycles(start - now);
 }
 
 bool
-ScratchpadMemory::isInSpm(const Address& address)
+ScratchpadMemory::tryBankAccess(const Address& address, int bytes)
 {
-    DPRINTF(RubySpm, "checking address: %s", address);
-    return false;
+    assert(m_controller != NULL);
+    Cycles now = m_controller->curCycle();
+    uint64 offset = addressToOffset(address);
+    int first = firstBankOf(offset);
+    int num_banks = numBanksOf(offset, bytes);
+
+    bool available = true;
+    for (int i = 0; i < num_banks; i++) {
+        int bank = (first + i) % m_num_banks;
+        if (m_port_free[earliestPort(bank)] > now) {
+            // The controller retries next cycle
+            m_bank_conflict_cycles[bank]++;
+            available = false;
+        }
+    }
+
+    if (!available) {
+        DPRINTF(RubyResourceStalls, "%s: bank conflict on %s\n", name(),
+                address);
+        return false;
+    }
+
+    for (int i = 0; i < num_banks; i++) {
+        int port = earliestPort((first + i) % m_num_banks);
+        m_port_free[port] = Cycles(now + m_bank_busy);
+    }
+    return true;
 }
-void
-ScratchpadMemory::readSpmData(const Address& address, DataBlock& datablock)
+
+bool
+ScratchpadMemory::tryLineAccess(const Address& address)
 {
-    DPRINTF(RubySpm, "readSpmData NOT IMPL!\n");
-    return;
+    return tryBankAccess(address, 1 << m_block_size_bits);
 }
-void
-ScratchpadMemory::writeSpmData(const Address& address, DataBlock& datablock)
-{
-    DPRINTF(RubySpm, "writeSpmData NOT IMPL!\n");
-    return;
-}
\ No newline at end of file
@@ -1,28 +1,73 @@
-
 #ifndef __MEM_RUBY_SYSTEM_SCRATCHPADMEMORY_HH__
 #define __MEM_RUBY_SYSTEM_SCRATCHPADMEMORY_HH__
 
+#include <deque>
+#include <map>
 #include <string>
 #include <vector>
 
-#include "base/hashmap.hh"
+#include "base/addr_range.hh"
 #include "base/statistics.hh"
-#include "mem/protocol/CacheRequestType.hh"
-#include "mem/protocol/CacheResourceType.hh"
+#include "base/types.hh"
+#include "enums/SpmInterleave.hh"
 #include "mem/protocol/RubyRequest.hh"
+#include "mem/protocol/SpmAccessType.hh"
+#include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/DataBlock.hh"
-#include "mem/ruby/recorder/CacheRecorder.hh"
-#include "mem/ruby/slicc_interface/AbstractCacheEntry.hh"
-#include "mem/ruby/slicc_interface/RubySlicc_ComponentMapping.hh"
-#include "mem/ruby/system/BankedArray.hh"
-#include "mem/ruby/system/LRUPolicy.hh"
-#include "mem/ruby/system/PseudoLRUPolicy.hh"
+#include "mem/ruby/system/MachineID.hh"
 #include "params/RubySpm.hh"
 #include "sim/sim_object.hh"
-
-class ScratchpadMemory : public SimObject
+#include "sim/spm_control.hh"
+
+class AbstractController;
+class CacheMemory;
+class SpmDMAEngine;
+
+/**
+ * A software managed scratchpad.  The SPM is a flat byte array that
+ * backs the physical window [base_addr, base_addr + size).  There are
+ * no tags and no replacement: an address inside the window maps to a
+ * fixed offset in the backing store, so every access is a bounds check
+ * plus a memcpy.
+ *
+ * The SPM is split into num_banks banks, interleaved by word or by line
+ * on the SPM offset.  Each bank starts at most ports_per_bank accesses a
+ * cycle, so accesses to different banks proceed in parallel and accesses
+ * to a busy bank wait for a port.
+ *
+ * Every SPM registers its window at init so that a controller can tell
+ * whether an address belongs to another core's SPM and which L1 owns it.
+ *
+ * The window may be larger than the SPM: SPMCONFIG hands ways of the L1
+ * data cache to the SPM, which then grows by a way's worth of bytes per
+ * way.  Only the first getSize() bytes of the window are SPM; the rest
+ * is ordinary cacheable memory.
+ *
+ * Besides its home window the SPM has a small region table.  Each entry
+ * maps another physical range [base, base + size) onto the SPM bytes
+ * [offset, offset + size), so that a kernel can keep its inputs, outputs
+ * and tables where they already live in the address space.  Regions are
+ * programmed through SPMCONFIG and may alias each other in the SPM, but
+ * not in the address space.  Lines of a range being mapped must not be
+ * cached anywhere; keeping it that way is up to software.
+ *
+ * Memory ranges may also be declared non-coherent.  Their lines are only
+ * meant to be reached through the DMA engines, which move them between
+ * memory and an SPM without the L2 taking a block for them or the
+ * directory recording an owner.  A line the L2 already holds still goes
+ * through the coherent path, so stray cached accesses stay correct.
+ */
+class ScratchpadMemory : public SimObject, public SpmControl
 {
-public:
+  public:
+    // A physical range mapped onto the SPM at a fixed offset
+    struct SpmRegion
+    {
+        Addr base;
+        Addr size;
+        Addr offset;
+    };
+
     typedef RubySpmParams Params;
     ScratchpadMemory(const Params *p);
     ~ScratchpadMemory();
@@ -30,121 +75,247 @@ public:
     void init();
 
     // Public Methods
-    // perform a cache access and see if we hit or not.  Return true on a hit.
-    bool tryCacheAccess(const Address& address, RubyRequestType type,
-                        DataBlock*& data_ptr);
-
-    // similar to above, but doesn't require full access check
-    bool testCacheAccess(const Address& address, RubyRequestType type,
-                         DataBlock*& data_ptr);
-
-    // tests to see if an address is present in the cache
-    bool isTagPresent(const Address& address) const;
-
-    // Returns true if there is:
-    //   a) a tag match on this address or there is
-    //   b) an unused line in the same cache "way"
-    bool cacheAvail(const Address& address) const;
-
-    // find an unused entry and sets the tag appropriate for the address
-    AbstractCacheEntry* allocate(const Address& address, AbstractCacheEntry* new_entry);
-    void allocateVoid(const Address& address, AbstractCacheEntry* new_entry)
-    {
-        allocate(address, new_entry);
-    }
-
-    // Explicitly free up this address
-    void deallocate(const Address& address);
-
-    // Returns with the physical address of the conflicting cache line
-    Address cacheProbe(const Address& address) const;
-
-    // looks an address up in the cache
-    AbstractCacheEntry* lookup(const Address& address);
-    const AbstractCacheEntry* lookup(const Address& address) const;
+    // true if the address falls in the window mapped onto this SPM
+    bool isInSpm(const Address& address) const;
+    // true if [base, base + length) is covered by one mapping of the SPM
+    bool isRangeInSpm(Addr base, Addr length) const;
+    // the same, once every queued SPMCONFIG request has been applied
+    bool isRangeInPendingSpm(Addr base, Addr length) const;
+    // true if the address falls in the window of some other core's SPM
+    bool isInRemoteSpm(const Address& address) const;
+    // L1 controller owning the SPM whose window holds the address
+    MachineID getRemoteOwner(const Address& address) const;
+
+    // The SPM whose window holds the address, NULL if there is none
+    static ScratchpadMemory* lookupWindow(const Address& address);
+    // true if some SPM window or region overlaps [base, base + size)
+    static bool overlapsAnyWindow(Addr base, Addr size)
+    { return overlapsWindow(base, size, NULL, 0); }
+    // true if the address falls in a range declared non-coherent
+    static bool isNonCoherent(const Address& address);
+
+    // Called by the controller that serves the SPM's window
+    void setController(AbstractController *ctrl);
+    const MachineID& getOwner() const { return m_owner; }
+
+    // Queue an SPMCONFIG request with the controller
+    bool partition(int ways);
+    bool setRegion(int index, Addr base, Addr size, Addr offset);
+    // Called by the controller once the ways taken hold no lines.  Applies
+    // the oldest SPMCONFIG request.
+    void applyConfig(int ways);
+    int getPartitionWays() const { return m_spm_ways; }
+    // SPMCONFIG requests queued and applied so far.  A DMA transfer
+    // waits for every request queued before it.
+    uint64 getConfigsQueued() const { return m_configs_queued; }
+    uint64 getConfigsApplied() const { return m_configs_applied; }
+    const SpmRegion& getRegion(int index) const;
+
+    // Region table entries picked by the scratchpad rather than software
+    int mapRegion(Addr base, Addr size, Addr offset);
+    bool unmapRegion(Addr base);
+
+    // Called by the DMA engine that serves the SPM
+    void setDMAEngine(SpmDMAEngine *dma);
+    int startDma(Addr src, Addr dst, Addr length, Addr stride,
+                 bool move_in);
+    bool waitDma(int id, Event *wakeup);
+
+    // Returns a view of the line holding the address.  The block aliases
+    // the backing store, so writes through it update the SPM directly.
+    DataBlock& getDataBlock(const Address& address);
+    const DataBlock& getDataBlock(const Address& address) const;
+
+    // Copy a whole line out of / into the SPM
+    void readSpmData(const Address& address, DataBlock& datablock) const;
+    void writeSpmData(const Address& address, const DataBlock& datablock);
 
     Cycles getLatency() const { return m_latency; }
+    Addr getBaseAddr() const { return m_base_addr; }
+    // bytes currently mapped onto the SPM
+    uint64_t getSize() const { return m_spm_size; }
+    uint64 getWindowSize() const { return m_window_size; }
 
-    // Hook for checkpointing the contents of the cache
-    void recordCacheContents(int cntrl, CacheRecorder* tr) const;
+    // SPM contents cannot be rebuilt by replaying loads, so the data
+    // image and region table go into the checkpoint as they are
+    void serialize(std::ostream &os);
+    void unserialize(Checkpoint *cp, const std::string &section);
 
-    // Set this address to most recently used
-    void setMRU(const Address& address);
-
-    void setLocked (const Address& addr, int context);
-    void clearLocked (const Address& addr);
-    bool isLocked (const Address& addr, int context);
-
-    // Print cache contents
+    // Print SPM contents
     void print(std::ostream& out) const;
     void printData(std::ostream& out) const;
 
     void regStats();
-    bool checkResourceAvailable(CacheResourceType res, Address addr);
-    void recordRequestType(CacheRequestType requestType);
-    
-    // SPM part
-    bool isInSpm(const Address& address);
-    void readSpmData(const Address& address, DataBlock& datablock);
-    void writeSpmData(const Address& address, DataBlock& datablock);
-
-public:
-    Stats::Scalar m_demand_hits;
-    Stats::Scalar m_demand_misses;
-    Stats::Formula m_demand_accesses;
-
-    Stats::Scalar m_sw_prefetches;
-    Stats::Scalar m_hw_prefetches;
-    Stats::Formula m_prefetches;
-
-    Stats::Vector m_accessModeType;
-
-    Stats::Scalar numDataArrayReads;
-    Stats::Scalar numDataArrayWrites;
-    Stats::Scalar numTagArrayReads;
-    Stats::Scalar numTagArrayWrites;
-
-    Stats::Scalar numTagArrayStalls;
-    Stats::Scalar numDataArrayStalls;
-
-private:
-    // convert a Address to its location in the cache
-    Index addressToCacheSet(const Address& address) const;
-
-    // Given a cache tag: returns the index of the tag in a set.
-    // returns -1 if the tag is not found.
-    int findTagInSet(Index line, const Address& tag) const;
-    int findTagInSetIgnorePermissions(Index cacheSet,
-                                      const Address& tag) const;
-
-                                      // Private copy constructor and assignment operator
-                                      ScratchpadMemory(const ScratchpadMemory& obj);
-                                      ScratchpadMemory& operator=(const ScratchpadMemory& obj);
-
-private:
-    const std::string m_cache_name;
-    Cycles m_latency;
 
-    // Data Members (m_prefix)
-    bool m_is_instruction_only_cache;
+    // Claim a port in every bank holding [address, address + bytes).
+    // bankAccess() always succeeds and returns the cycles the access
+    // waits for a port; tryBankAccess() claims the ports only if they
+    // are all free this cycle, so that the caller can retry.
+    Cycles bankAccess(const Address& address, int bytes);
+    bool tryBankAccess(const Address& address, int bytes);
+    bool tryLineAccess(const Address& address);
+
+    // Account an access of bytes bytes at address, or of the whole line
+    void recordAccess(SpmAccessType type, const Address& address,
+                      int bytes);
+    void recordLineAccess(SpmAccessType type, const Address& address);
+
+  public:
+    //! Accesses and bytes moved, by who made them
+    Stats::Vector m_accesses;
+    Stats::Vector m_bytes;
+
+    //! Cycles requests waited on a busy bank, per bank
+    Stats::Vector m_bank_conflict_cycles;
+
+    //! Most bytes holding data at once.  A line holds data from the
+    //! first write to it until a DMA engine moves it out.
+    Stats::Scalar m_occupancy_peak;
+
+    //! Dynamic energy in pJ
+    Stats::Formula m_read_energy;
+    Stats::Formula m_write_energy;
+    Stats::Formula m_dynamic_energy;
+
+  private:
+    // A range of the address space claimed by some SPM
+    struct SpmWindow
+    {
+        Addr size;
+        ScratchpadMemory *spm;
+    };
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    m5::hash_map<Address, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    // An SPMCONFIG request waiting in the mandatory queue
+    struct SpmConfig
+    {
+        // -1 for a change of partition
+        int index;
+        SpmRegion region;
+    };
+
+    // Region holding the address, NULL if there is none.  Consecutive
+    // accesses mostly hit the same region, so the last match is checked
+    // before the binary search.
+    const SpmRegion* lookupRegion(Addr addr) const
+    {
+        if (m_regions.empty())
+            return NULL;
+        const SpmRegion *r = &m_regions[m_last_region];
+        if (addr - r->base < r->size)
+            return r;
+        return findRegion(addr);
+    }
+    const SpmRegion* findRegion(Addr addr) const;
 
-    AbstractReplacementPolicy *m_replacementPolicy_ptr;
+    // byte offset of an address within the backing store
+    uint64 addressToOffset(const Address& address) const
+    {
+        Addr addr = address.getAddress();
+        if (addr - m_base_addr < m_spm_size)
+            return addr - m_base_addr;
+        const SpmRegion *r = lookupRegion(addr);
+        assert(r != NULL);
+        return addr - r->base + r->offset;
+    }
+
+    // line index of an address within the backing store
+    Index addressToLine(const Address& address) const
+    {
+        return addressToOffset(address) >> m_block_size_bits;
+    }
 
-    BankedArray dataArray;
-    BankedArray tagArray;
+    // check a mapping against the SPM size and every other window
+    bool checkRegion(int index, const SpmRegion& region, uint64 spm_size,
+                     bool quiet) const;
+    void setPartition(int ways);
+    // bytes mapped onto the SPM once m_pending has been applied
+    uint64 pendingSpmSize() const;
+    void applyRegion(int index, const SpmRegion& region);
+    // rebuild m_regions from the table
+    void sortRegions();
+    // the region table as it will be once m_pending has been applied
+    std::vector<SpmRegion> pendingRegionTable() const;
+
+    static bool overlapsWindow(Addr base, Addr size,
+                               const ScratchpadMemory *spm, Addr spm_base);
+    static void addWindow(Addr base, Addr size, ScratchpadMemory *spm);
+    static void removeWindow(Addr base, const ScratchpadMemory *spm);
+    void addNonCoherentRange(Addr base, Addr size);
+
+    // Private copy constructor and assignment operator
+    ScratchpadMemory(const ScratchpadMemory& obj);
+    ScratchpadMemory& operator=(const ScratchpadMemory& obj);
+
+  private:
+    // base address -> owner, for every window and region in the system
+    static std::map<Addr, SpmWindow> s_windows;
+    // base address -> size of every non-coherent range in the system
+    static std::map<Addr, Addr> s_noncoherent;
 
-    int m_cache_size;
-    std::string m_policy;
-    int m_cache_num_sets;
-    int m_cache_num_set_bits;
-    int m_cache_assoc;
-    int m_start_index_bit;
-    bool m_resource_stalls;
+    Cycles m_latency;
+    MachineID m_owner;
+    AbstractController *m_controller;
+    SpmDMAEngine *m_dma;
+
+    Addr m_base_addr;
+    // bytes mapped onto the SPM, m_base_size plus any borrowed ways
+    uint64 m_spm_size;
+    // capacity of the SPM without borrowed ways
+    uint64 m_base_size;
+    // bytes reserved in the address space, backed by m_data
+    uint64 m_window_size;
+    uint64 m_num_lines;
+
+    // L1 data cache ways can be borrowed from, may be NULL
+    CacheMemory *m_cache;
+    int m_spm_ways;
+    unsigned int m_block_size_bits;
+
+    // The region table as programmed, an entry with size 0 is unused
+    std::vector<SpmRegion> m_region_table;
+    // The mapped entries sorted by base, for lookups
+    std::vector<SpmRegion> m_regions;
+    mutable int m_last_region;
+
+    // Ranges this SPM declares non-coherent, registered at init
+    std::vector<AddrRange> m_noncoherent_ranges;
+
+    // SPMCONFIG requests in the order they were queued, and the
+    // partition that will be in force once they have all been applied
+    std::deque<SpmConfig> m_pending;
+    int m_config_ways;
+    uint64 m_configs_queued;
+    uint64 m_configs_applied;
+
+    // The backing store and one DataBlock view per line onto it
+    uint8_t *m_data;
+    std::vector<DataBlock> m_blocks;
+
+    // Lines holding data, for the occupancy statistic
+    std::vector<bool> m_occupied;
+    uint64 m_num_occupied;
+
+    // The SPM bytes [offset, offset + bytes) are held by numBanksOf()
+    // banks in a row, modulo m_num_banks, starting at firstBankOf()
+    int firstBankOf(uint64 offset) const
+    { return (offset >> m_interleave_bits) % m_num_banks; }
+    int numBanksOf(uint64 offset, int bytes) const;
+    // port of a bank that is free soonest
+    int earliestPort(int bank) const;
+
+    int m_num_banks;
+    int m_ports_per_bank;
+    Cycles m_bank_busy;
+    // log2 of the bytes mapped to a bank before moving to the next
+    unsigned int m_interleave_bits;
+    Enums::SpmInterleave m_interleave;
+    int m_word_size;
+    // cycle at which each port of each bank is next free, bank major
+    std::vector<Cycles> m_port_free;
+
+    // pJ per access
+    double m_read_energy_pj;
+    double m_write_energy_pj;
 };
 
 std::ostream& operator<<(std::ostream& out, const ScratchpadMemory& obj);
@@ -55,7 +55,7 @@ RubySequencerParams::create()
 }
 
 Sequencer::Sequencer(const Params *p)
-    : RubyPort(p), deadlockCheckEvent(this)
+    : RubyPort(p), deadlockCheckEvent(this), spmHitEvent(this)
 {
     m_store_waiting_on_load_cycles = 0;
     m_store_waiting_on_store_cycles = 0;
@@ -66,6 +66,8 @@ Sequencer::Sequencer(const Params *p)
 
     m_instCache_ptr = p->icache;
     m_dataCache_ptr = p->dcache;
+    m_spm_ptr = p->spm;
+    m_spm_profiler_ptr = p->spm_profiler;
     m_max_outstanding_requests = p->max_outstanding_requests;
     m_deadlock_threshold = p->deadlock_threshold;
 
@@ -74,6 +76,14 @@ Sequencer::Sequencer(const Params *p)
     assert(m_instCache_ptr != NULL);
     assert(m_dataCache_ptr != NULL);
 
+    m_data_latency = m_dataCache_ptr->getLatency();
+    m_spm_latency = m_spm_ptr != NULL ? m_spm_ptr->getLatency() : Cycles(0);
+    if (m_spm_ptr != NULL && p->parallel_spm_probe) {
+        if (m_spm_latency > m_data_latency)
+            m_data_latency = m_spm_latency;
+        m_spm_latency = m_data_latency;
+    }
+
     m_usingNetworkTester = p->using_network_tester;
 }
 
@@ -389,6 +399,15 @@ Sequencer::handleLlsc(const Address& address, SequencerRequest* request)
     // longer locked.
     //
     bool success = true;
+
+    // SPM lines are never cached, so there is no lock to clear.  LL/SC
+    // to an SPM is refused by makeRequest().
+    if (ScratchpadMemory::lookupWindow(address) != NULL) {
+        assert(request->m_type != RubyRequestType_Load_Linked &&
+               request->m_type != RubyRequestType_Store_Conditional);
+        return true;
+    }
+
     if (request->m_type == RubyRequestType_Store_Conditional) {
         if (!m_dataCache_ptr->isLocked(address, m_version)) {
             //
@@ -571,6 +590,12 @@ Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
     recordMissLatency(total_latency, type, mach, externalHit, issued_time,
                       initialRequestTime, forwardRequestTime,
                       firstResponseTime, curCycle());
+    if (m_spm_profiler_ptr != NULL && type != RubyRequestType_IFETCH &&
+        !g_system_ptr->m_warmup_enabled &&
+        !g_system_ptr->m_cooldown_enabled) {
+        m_spm_profiler_ptr->profileAccess(request_address, type,
+                                          total_latency);
+    }
 
     DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %s %d cycles\n",
              curTick(), m_version, "Seq",
@@ -634,7 +659,140 @@ Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
 bool
 Sequencer::empty() const
 {
-    return m_writeRequestTable.empty() && m_readRequestTable.empty();
+    return m_writeRequestTable.empty() && m_readRequestTable.empty() &&
+        m_spmRequestQueue.empty();
+}
+
+// Plain loads and stores to the local SPM window can be serviced by the
+// sequencer itself.  Atomics, LL/SC and instruction fetches still go
+// through the controller, as does anything the cache recorder or the
+// ruby tester needs to observe.
+bool
+Sequencer::isSpmRequest(PacketPtr pkt, RubyRequestType request_type) const
+{
+    if (m_spm_ptr == NULL || m_usingRubyTester ||
+        g_system_ptr->m_warmup_enabled || g_system_ptr->m_cooldown_enabled) {
+        return false;
+    }
+
+    if ((request_type != RubyRequestType_LD) &&
+        (request_type != RubyRequestType_ST)) {
+        return false;
+    }
+
+    return m_spm_ptr->isInSpm(Address(pkt->getAddr()));
+}
+
+void
+Sequencer::issueSpmRequest(PacketPtr pkt, RubyRequestType request_type)
+{
+    DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %#x %s\n",
+             curTick(), m_version, "Seq", "SPM Begin", "", "",
+             pkt->getAddr(), RubyRequestType_to_string(request_type));
+
+    // Requests to different banks overlap, so a later request may
+    // finish first.  Keep the queue sorted by completion time.
+    Cycles bank_wait = m_spm_ptr->bankAccess(Address(pkt->getAddr()),
+                                             pkt->getSize());
+    SpmRequest request;
+    request.pkt = pkt;
+    request.m_type = request_type;
+    request.issue_time = curCycle();
+    request.ready_time = clockEdge(Cycles(bank_wait + m_spm_latency));
+    queueSpmRequest(request);
+}
+
+void
+Sequencer::queueSpmRequest(const SpmRequest& request)
+{
+    deque<SpmRequest>::iterator it = m_spmRequestQueue.end();
+    while (it != m_spmRequestQueue.begin() &&
+           (it - 1)->ready_time > request.ready_time) {
+        --it;
+    }
+    m_spmRequestQueue.insert(it, request);
+    scheduleSpmWakeup(request.ready_time);
+}
+
+void
+Sequencer::scheduleSpmWakeup(Tick when)
+{
+    if (!spmHitEvent.scheduled()) {
+        schedule(spmHitEvent, when);
+    } else if (spmHitEvent.when() > when) {
+        reschedule(spmHitEvent, when);
+    }
+}
+
+void
+Sequencer::spmWakeup()
+{
+    while (!m_spmRequestQueue.empty() &&
+           m_spmRequestQueue.front().ready_time <= curTick()) {
+        SpmRequest request = m_spmRequestQueue.front();
+        m_spmRequestQueue.pop_front();
+
+        PacketPtr pkt = request.pkt;
+        Address request_address(pkt->getAddr());
+        Address request_line_address(pkt->getAddr());
+        request_line_address.makeLineAddress();
+
+        // An SPMCONFIG applied while the request waited for its bank may
+        // have unmapped the address, in which case it goes to the
+        // controller like any other access
+        if (!m_spm_ptr->isInSpm(request_address)) {
+            DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %s\n",
+                     curTick(), m_version, "Seq", "SPM Unmapped", "", "",
+                     request_address);
+            if (insertRequest(pkt, request.m_type) == RequestStatus_Ready) {
+                issueRequest(pkt, request.m_type);
+            } else {
+                // Retry once the aliasing request is done
+                request.ready_time = clockEdge(Cycles(1));
+                queueSpmRequest(request);
+            }
+            continue;
+        }
+
+        DataBlock& data = m_spm_ptr->getDataBlock(request_line_address);
+
+        if (pkt->getPtr<uint8_t>(true) != NULL) {
+            if (request.m_type == RubyRequestType_LD) {
+                memcpy(pkt->getPtr<uint8_t>(true),
+                       data.getData(request_address.getOffset(),
+                                    pkt->getSize()),
+                       pkt->getSize());
+                m_spm_ptr->recordAccess(SpmAccessType_LocalRead,
+                                        request_address, pkt->getSize());
+            } else {
+                data.setData(pkt->getPtr<uint8_t>(true),
+                             request_address.getOffset(), pkt->getSize());
+                m_spm_ptr->recordAccess(SpmAccessType_LocalWrite,
+                                        request_address, pkt->getSize());
+            }
+        } else {
+            DPRINTF(MemoryAccess,
+                    "WARNING.  Data not transfered from SPM to M5 for "
+                    "type %s\n", RubyRequestType_to_string(request.m_type));
+        }
+
+        assert(curCycle() >= request.issue_time);
+        Cycles total_latency = curCycle() - request.issue_time;
+        recordMissLatency(total_latency, request.m_type, MachineType_NUM,
+                          false, request.issue_time, Cycles(0), Cycles(0),
+                          Cycles(0), curCycle());
+
+        DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %s %d cycles\n",
+                 curTick(), m_version, "Seq", "SPM Done", "", "",
+                 request_address, total_latency);
+
+        ruby_hit_callback(pkt);
+    }
+
+    // A retry or a request made from a hit callback may have scheduled
+    // the event already
+    if (!m_spmRequestQueue.empty())
+        scheduleSpmWakeup(m_spmRequestQueue.front().ready_time);
 }
 
 RequestStatus
@@ -712,6 +870,36 @@ Sequencer::makeRequest(PacketPtr pkt)
         }
     }
 
+    // An SPM keeps no LL/SC reservations, and another core's SPM only
+    // serves plain loads and stores, so it cannot give the atomicity
+    // these ask for.  A fetch from another core's SPM is a plain load.
+    ScratchpadMemory *window =
+        ScratchpadMemory::lookupWindow(Address(pkt->getAddr()));
+    if (window != NULL) {
+        if (pkt->isLLSC()) {
+            fatal("%s: %s to the spm address %#x is not supported\n",
+                  name(), RubyRequestType_to_string(primary_type),
+                  pkt->getAddr());
+        }
+        if (window != m_spm_ptr) {
+            if (primary_type == RubyRequestType_IFETCH) {
+                primary_type = secondary_type = RubyRequestType_LD;
+            } else if (primary_type != RubyRequestType_LD &&
+                       primary_type != RubyRequestType_ST &&
+                       primary_type != RubyRequestType_FLUSH) {
+                fatal("%s: %s to the remote spm address %#x is not "
+                      "supported\n", name(),
+                      RubyRequestType_to_string(primary_type),
+                      pkt->getAddr());
+            }
+        }
+    }
+
+    if (isSpmRequest(pkt, primary_type)) {
+        issueSpmRequest(pkt, primary_type);
+        return RequestStatus_Issued;
+    }
+
     RequestStatus status = insertRequest(pkt, primary_type);
     if (status != RequestStatus_Ready)
         return status;
@@ -753,7 +941,7 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
     if (secondary_type == RubyRequestType_IFETCH)
         latency = m_instCache_ptr->getLatency();
     else
-        latency = m_dataCache_ptr->getLatency();
+        latency = m_data_latency;
 
     // Send the message to the cache controller
     assert(latency > 0);
@@ -29,6 +29,7 @@
 #ifndef __MEM_RUBY_SYSTEM_SEQUENCER_HH__
 #define __MEM_RUBY_SYSTEM_SEQUENCER_HH__
 
+#include <deque>
 #include <iostream>
 
 #include "base/hashmap.hh"
@@ -36,7 +37,8 @@
 #include "mem/protocol/RubyRequestType.hh"
 #include "mem/protocol/SequencerRequestType.hh"
 #include "mem/ruby/common/Address.hh"
-//#include "mem/ruby/system/CacheMemory.hh"
+#include "mem/ruby/profiler/SpmPlacementProfiler.hh"
+#include "mem/ruby/system/CacheMemory.hh"
 #include "mem/ruby/system/RubyPort.hh"
 #include "mem/ruby/system/ScratchpadMemory.hh"
 #include "params/RubySequencer.hh"
@@ -66,6 +68,7 @@ class Sequencer : public RubyPort
 
     // Public Methods
     void wakeup(); // Used only for deadlock detection
+    void spmWakeup(); // Completes requests serviced by the local SPM
     void printProgress(std::ostream& out) const;
     void clearStats();
 
@@ -87,7 +90,8 @@ class Sequencer : public RubyPort
 
     RequestStatus makeRequest(PacketPtr pkt);
     bool empty() const;
-    int outstandingCount() const { return m_outstanding_count; }
+    int outstandingCount() const
+    { return m_outstanding_count + m_spmRequestQueue.size(); }
 
     bool isDeadlockEventScheduled() const
     { return deadlockCheckEvent.scheduled(); }
@@ -164,6 +168,8 @@ class Sequencer : public RubyPort
                            Cycles completionTime);
 
     RequestStatus insertRequest(PacketPtr pkt, RubyRequestType request_type);
+    bool isSpmRequest(PacketPtr pkt, RubyRequestType request_type) const;
+    void issueSpmRequest(PacketPtr pkt, RubyRequestType request_type);
     bool handleLlsc(const Address& address, SequencerRequest* request);
 
     // Private copy constructor and assignment operator
@@ -174,10 +180,29 @@ class Sequencer : public RubyPort
     int m_max_outstanding_requests;
     Cycles m_deadlock_threshold;
 
-    //CacheMemory* m_dataCache_ptr;
-    //CacheMemory* m_instCache_ptr;
-    ScratchpadMemory* m_dataCache_ptr;
-    ScratchpadMemory* m_instCache_ptr;
+    CacheMemory* m_dataCache_ptr;
+    CacheMemory* m_instCache_ptr;
+    ScratchpadMemory* m_spm_ptr;
+    SpmPlacementProfiler* m_spm_profiler_ptr;
+
+    //! Latencies of an L1 data cache access and of a local SPM access.
+    //! When the two are probed in parallel both take the slower one.
+    Cycles m_data_latency;
+    Cycles m_spm_latency;
+
+    //! Requests to the local SPM bypass the request tables and the
+    //! controller.  They are kept sorted by the time they complete.
+    struct SpmRequest
+    {
+        PacketPtr pkt;
+        RubyRequestType m_type;
+        Cycles issue_time;
+        Tick ready_time;
+    };
+    std::deque<SpmRequest> m_spmRequestQueue;
+    void queueSpmRequest(const SpmRequest& request);
+    // Wake up at when unless the event is due sooner already
+    void scheduleSpmWakeup(Tick when);
 
     typedef m5::hash_map<Address, SequencerRequest*> RequestTable;
     RequestTable m_writeRequestTable;
@@ -240,6 +265,19 @@ class Sequencer : public RubyPort
     };
 
     SequencerWakeupEvent deadlockCheckEvent;
+
+    class SequencerSpmEvent : public Event
+    {
+      private:
+        Sequencer *m_sequencer_ptr;
+
+      public:
+        SequencerSpmEvent(Sequencer *_seq) : m_sequencer_ptr(_seq) {}
+        void process() { m_sequencer_ptr->spmWakeup(); }
+        const char *description() const { return "Sequencer SPM hit"; }
+    };
+
+    SequencerSpmEvent spmHitEvent;
 };
 
 inline std::ostream&
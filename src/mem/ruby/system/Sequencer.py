@@ -58,10 +58,14 @@ class RubySequencer(RubyPort):
     type = 'RubySequencer'
     cxx_class = 'Sequencer'
     cxx_header = "mem/ruby/system/Sequencer.hh"
-    #icache = Param.RubyCache("")
-    #dcache = Param.RubyCache("")
-    icache = Param.RubySpm("")
-    dcache = Param.RubySpm("")
+    icache = Param.RubyCache("")
+    dcache = Param.RubyCache("")
+    spm = Param.RubySpm(NULL, "local scratchpad serviced by the sequencer")
+    parallel_spm_probe = Param.Bool(False,
+        "probe the spm and the data cache in the same cycle, so that every "
+        "data access takes the slower of the two latencies")
+    spm_profiler = Param.SpmPlacementProfiler(NULL,
+        "profiles the demand data accesses for spm placement")
     max_outstanding_requests = Param.Int(16,
         "max requests (incl. prefetches) outstanding")
     deadlock_threshold = Param.Cycles(500000,
@@ -2,19 +2,31 @@ from m5.params import *
 from m5.SimObject import SimObject
 from Controller import RubyController
 
+# Granularity at which consecutive spm bytes are spread over the banks
+class SpmInterleave(Enum): vals = ['word', 'line']
+
 class RubySpm(SimObject):
     type = 'RubySpm'
     cxx_class = 'ScratchpadMemory'
     cxx_header = "mem/ruby/system/ScratchpadMemory.hh"
     size = Param.MemorySize("capacity in bytes");
+    window_size = Param.MemorySize("0", "bytes of address space reserved "
+        "for the spm, room to grow into borrowed cache ways; 0 for size")
+    cache = Param.RubyCache(NULL, "L1 data cache whose ways SPMCONFIG "
+        "may hand to the spm")
     latency = Param.Cycles("");
-    assoc = Param.Int("");
-    replacement_policy = Param.String("PSEUDO_LRU", "");
-    start_index_bit = Param.Int(6, "index start, default 6 for 64-byte line");
-    is_icache = Param.Bool(False, "is instruction only cache");
+    base_addr = Param.Addr(0, "start of the physical window mapped onto the spm");
+    num_regions = Param.Int(8, "entries in the region table, each maps "
+        "another physical range onto the spm")
+    noncoherent_ranges = VectorParam.AddrRange([], "memory only reached "
+        "through spm dma, moved without l2 blocks or directory owners")
+
+    num_banks = Param.Int(1, "number of independently accessed banks")
+    bank_interleave = Param.SpmInterleave('line',
+        "spread consecutive words or lines over the banks")
+    word_size = Param.Int(8, "bytes in a bank word")
+    ports_per_bank = Param.Int(1, "accesses a bank can start per cycle")
+    bank_busy_cycles = Param.Cycles(1, "cycles an access holds a bank port")
 
-    dataArrayBanks = Param.Int(1, "Number of banks for the data array")
-    tagArrayBanks = Param.Int(1, "Number of banks for the tag array")
-    dataAccessLatency = Param.Cycles(1, "cycles for a data array access")
-    tagAccessLatency = Param.Cycles(1, "cycles for a tag array access")
-    resourceStalls = Param.Bool(False, "stall if there is a resource failure")
\ No newline at end of file
+    read_energy = Param.Float(0.0, "dynamic energy of a read access in pJ")
+    write_energy = Param.Float(0.0, "dynamic energy of a write access in pJ")
@@ -36,8 +36,13 @@
 #include "debug/RubyCacheTrace.hh"
 #include "debug/RubySystem.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/SharerSet.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/profiler/Profiler.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+#include "mem/ruby/slicc_interface/RubySlicc_ComponentMapping.hh"
+#include "mem/ruby/system/HeldLineFilter.hh"
+#include "mem/ruby/system/ScratchpadMemory.hh"
 #include "mem/ruby/system/System.hh"
 #include "sim/eventq.hh"
 #include "sim/simulate.hh"
@@ -65,6 +70,8 @@ RubySystem::RubySystem(const Params *p)
     assert(isPowerOf2(m_block_size_bytes));
     m_block_size_bits = floorLog2(m_block_size_bytes);
 
+    SharerSet::configure(p->sharer_pointers, p->sharer_vector_bits);
+
     m_memory_size_bytes = p->mem_size;
     if (m_memory_size_bytes == 0) {
         m_memory_size_bits = 0;
@@ -409,6 +416,23 @@ RubySystem::resetStats()
     g_ruby_start = curCycle();
 }
 
+AbstractController*
+RubySystem::functionalHome(const Address& line_address) const
+{
+    // SPM lines live outside the caches and TBEs the filter tracks
+    if (HeldLineFilter::mayBeHeld(line_address) ||
+        ScratchpadMemory::lookupWindow(line_address) != NULL) {
+        return NULL;
+    }
+
+    MachineID home = map_Address_to_Directory(line_address);
+    const map<uint32_t, AbstractController *> &cntrls =
+        g_abs_controls[home.getType()];
+    map<uint32_t, AbstractController *>::const_iterator it =
+        cntrls.find(home.getNum());
+    return it == cntrls.end() ? NULL : it->second;
+}
+
 bool
 RubySystem::functionalRead(PacketPtr pkt)
 {
@@ -421,6 +445,27 @@ RubySystem::functionalRead(PacketPtr pkt)
 
     DPRINTF(RubySystem, "Functional Read request for %s\n",address);
 
+    uint8_t *data = pkt->getPtr<uint8_t>(true);
+    unsigned int size_in_bytes = pkt->getSize();
+    unsigned startByte = address.getAddress() - line_address.getAddress();
+
+    // When nothing but the home holds the line there is nobody else to ask
+    AbstractController *home = functionalHome(line_address);
+    if (home != NULL) {
+        access_perm = home->getAccessPermission(line_address);
+        if (access_perm == AccessPermission_Read_Only ||
+            access_perm == AccessPermission_Read_Write ||
+            access_perm == AccessPermission_Backing_Store) {
+            DataBlock& block = home->getDataBlock(line_address);
+            DPRINTF(RubySystem, "reading from home %s block %s\n",
+                    home->name(), block);
+            for (unsigned j = 0; j < size_in_bytes; ++j) {
+                data[j] = block.getByte(j + startByte);
+            }
+            return true;
+        }
+    }
+
     unsigned int num_ro = 0;
     unsigned int num_rw = 0;
     unsigned int num_busy = 0;
@@ -449,10 +494,6 @@ RubySystem::functionalRead(PacketPtr pkt)
     }
     assert(num_rw <= 1);
 
-    uint8_t *data = pkt->getPtr<uint8_t>(true);
-    unsigned int size_in_bytes = pkt->getSize();
-    unsigned startByte = address.getAddress() - line_address.getAddress();
-
     // This if case is meant to capture what happens in a Broadcast/Snoop
     // protocol where the block does not exist in the cache hierarchy. You
     // only want to read from the Backing_Store memory if there is no copy in
@@ -528,6 +569,29 @@ RubySystem::functionalWrite(PacketPtr pkt)
 
     uint32_t M5_VAR_USED num_functional_writes = 0;
 
+    // Without messages in flight, a line only the home holds has no other
+    // copy to update.  The memory controllers keep their own queues.
+    AbstractController *home =
+        Message::numLive() == 0 ? functionalHome(line_addr) : NULL;
+    if (home != NULL) {
+        access_perm = home->getAccessPermission(line_addr);
+        if (access_perm != AccessPermission_Invalid &&
+            access_perm != AccessPermission_NotPresent) {
+            num_functional_writes++;
+            DataBlock& block = home->getDataBlock(line_addr);
+            for (unsigned j = 0; j < size_in_bytes; ++j) {
+                block.setByte(j + startByte, data[j]);
+            }
+            DPRINTF(RubySystem, "wrote home %s block %s\n", home->name(),
+                    block);
+        }
+        for (unsigned int i = 0; i < m_memory_controller_vec.size(); ++i) {
+            num_functional_writes +=
+                m_memory_controller_vec[i]->functionalWriteBuffers(pkt);
+        }
+        return true;
+    }
+
     for (unsigned int i = 0; i < num_controllers;++i) {
         num_functional_writes +=
             m_abs_cntrl_vec[i]->functionalWriteBuffers(pkt);
@@ -119,6 +119,14 @@ class RubySystem : public ClockedObject
     void registerSparseMemory(SparseMemory*);
     void registerMemController(MemoryControl *mc);
 
+    // Checkpoint files are gzip compressed.  writeCompressedTrace takes
+    // ownership of raw_data; readCompressedTrace allocates it.
+    static void readCompressedTrace(std::string filename,
+                                    uint8_t *&raw_data,
+                                    uint64& uncompressed_trace_size);
+    static void writeCompressedTrace(uint8_t *raw_data, std::string file,
+                                     uint64 uncompressed_trace_size);
+
     bool eventQueueEmpty() { return eventq->empty(); }
     void enqueueRubyEvent(Tick tick)
     {
@@ -127,16 +135,14 @@ class RubySystem : public ClockedObject
     }
 
   private:
+    // The controller backing a line that no cache or TBE can be holding,
+    // NULL if functional accesses have to ask every controller
+    AbstractController* functionalHome(const Address& line_address) const;
+
     // Private copy constructor and assignment operator
     RubySystem(const RubySystem& obj);
     RubySystem& operator=(const RubySystem& obj);
 
-    void readCompressedTrace(std::string filename,
-                             uint8_t *&raw_data,
-                             uint64& uncompressed_trace_size);
-    void writeCompressedTrace(uint8_t *raw_data, std::string file,
-                              uint64 uncompressed_trace_size);
-
   private:
     // configuration parameters
     static int m_random_seed;
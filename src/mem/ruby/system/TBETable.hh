@@ -33,6 +33,7 @@
 
 #include "base/hashmap.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/system/HeldLineFilter.hh"
 
 template<class ENTRY>
 class TBETable
@@ -94,6 +95,7 @@ TBETable<ENTRY>::allocate(const Address& address)
     assert(!isPresent(address));
     assert(m_map.size() < m_number_of_TBEs);
     m_map[address] = ENTRY();
+    HeldLineFilter::add(line_address(address));
 }
 
 template<class ENTRY>
@@ -103,6 +105,7 @@ TBETable<ENTRY>::deallocate(const Address& address)
     assert(isPresent(address));
     assert(m_map.size() > 0);
     m_map.erase(address);
+    HeldLineFilter::remove(line_address(address));
 }
 
 // looks an address up in the cache
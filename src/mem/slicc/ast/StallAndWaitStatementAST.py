@@ -45,5 +45,4 @@ class StallAndWaitStatementAST(StatementAST):
         address_code = self.address.var.code
         code('''
         stallBuffer(&($in_port_code), $address_code);
-        $in_port_code.stallMessage($address_code);
         ''')
@@ -45,7 +45,8 @@ python_class_map = {
                     "DMASequencer": "DMASequencer",
                     "Prefetcher":"Prefetcher",
                     "Cycles":"Cycles",
-                    "ScratchpadMemory": "RubySpm"
+                    "ScratchpadMemory": "RubySpm",
+                    "SpmDMAEngine": "SpmDMAEngine"
                    }
 
 class StateMachine(Symbol):
@@ -54,6 +55,8 @@ class StateMachine(Symbol):
         self.table = None
         self.config_parameters = config_parameters
         self.prefetchers = []
+        self.spm_dma_engines = []
+        self.spms = []
 
         for param in config_parameters:
             if param.pointer:
@@ -65,6 +68,10 @@ class StateMachine(Symbol):
             self.symtab.registerSym(param.name, var)
             if str(param.type_ast.type) == "Prefetcher":
                 self.prefetchers.append(var)
+            if str(param.type_ast.type) == "SpmDMAEngine":
+                self.spm_dma_engines.append(var)
+            if str(param.type_ast.type) == "ScratchpadMemory":
+                self.spms.append(var)
 
         self.states = orderdict()
         self.events = orderdict()
@@ -666,6 +673,14 @@ $vid->setDescription("[Version " + to_string(m_version) + ", ${ident}, name=${{v
         for prefetcher in self.prefetchers:
             code('${{prefetcher.code}}.setController(this);')
 
+        # Set the SPM DMA engines
+        for engine in self.spm_dma_engines:
+            code('${{engine.code}}.setController(this);')
+
+        # Tell the SPMs which controller serves their window
+        for spm in self.spms:
+            code('${{spm.code}}.setController(this);')
+
         code()
         for port in self.in_ports:
             # Set the queue consumers
@@ -716,6 +731,8 @@ $vid->setDescription("[Version " + to_string(m_version) + ", ${ident}, name=${{v
 void
 $c_ident::regStats()
 {
+    AbstractController::regStats();
+
     if (m_version == 0) {
         for (${ident}_Event event = ${ident}_Event_FIRST;
              event < ${ident}_Event_NUM; ++event) {
@@ -904,7 +921,7 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
         #
         code.indent()
         for param in self.config_parameters:
-            if param.type_ast.type.ident == "CacheMemory" or param.type_ast.type.ident == "ScratchpadMemory":
+            if param.type_ast.type.ident == "CacheMemory":
                 assert(param.pointer)
                 code('m_${{param.ident}}_ptr->recordCacheContents(cntrl, tr);')
 
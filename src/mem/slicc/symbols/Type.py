@@ -75,8 +75,7 @@ class Type(Symbol):
         if self.ident in ("CacheMemory", "NewCacheMemory",
                           "TLCCacheMemory", "DNUCACacheMemory",
                           "DNUCABankCacheMemory", "L2BankCacheMemory",
-                          "CompressedCacheMemory", "PrefetchCacheMemory",
-                          "ScratchpadMemory"):
+                          "CompressedCacheMemory", "PrefetchCacheMemory"):
             self["cache"] = "yes"
 
         if self.ident in ("TBETable", "DNUCATBETable", "DNUCAStopTable"):
@@ -230,6 +229,9 @@ class Type(Symbol):
 #include "mem/ruby/slicc_interface/RubySlicc_Util.hh"
 ''')
 
+        if self.isMessage:
+            code('#include "mem/ruby/slicc_interface/MessagePool.hh"')
+
         for dm in self.data_members.values():
             if not dm.type.isPrimitive:
                 code('#include "mem/protocol/$0.hh"', dm.type.c_ident)
@@ -320,6 +322,22 @@ clone() const
 {
      return new ${{self.c_ident}}(*this);
 }
+''')
+
+        if self.isMessage:
+            # messages come and go with every transaction, recycle them
+            code('''
+static void*
+operator new(size_t size)
+{
+    return s_pool.allocate(size);
+}
+
+static void
+operator delete(void *ptr, size_t size)
+{
+    s_pool.release(ptr, size);
+}
 ''')
 
         if not self.isGlobal:
@@ -395,6 +413,9 @@ set${{dm.ident}}(const ${{dm.type.c_ident}}& local_${{dm.ident}})
             if proto:
                 code('$proto')
 
+        if self.isMessage:
+            code('static MessagePool s_pool;')
+
         code.dedent()
         code('};')
 
@@ -430,6 +451,9 @@ operator<<(std::ostream& out, const ${{self.c_ident}}& obj)
 using namespace std;
 ''')
 
+        if self.isMessage:
+            code('MessagePool ${{self.c_ident}}::s_pool(sizeof(${{self.c_ident}}));')
+
         code('''
 /** \\brief Print the state of this object */
 void
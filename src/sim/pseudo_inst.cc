@@ -68,6 +68,7 @@
 #include "sim/serialize.hh"
 #include "sim/sim_events.hh"
 #include "sim/sim_exit.hh"
+#include "sim/spm_control.hh"
 #include "sim/stat_control.hh"
 #include "sim/stats.hh"
 #include "sim/system.hh"
@@ -190,6 +191,30 @@ pseudoInst(ThreadContext *tc, uint8_t func, uint8_t subfunc)
         workend(tc, args[0], args[1]);
         break;
 
+      case 0x5c: // spm_config_func
+        return spmConfig(tc, args[0]);
+
+      case 0x5d: // spm_region_func
+        return spmRegion(tc, args[0], args[1], args[2], args[3]);
+
+      case 0x5e: // spm_map_func
+        return spmMap(tc, args[0], args[1], args[2]);
+
+      case 0x5f: // spm_unmap_func
+        return spmUnmap(tc, args[0]);
+
+      case 0x60: // spm_dma_in_func
+        return spmDma(tc, args[0], args[1], args[2], args[3], true);
+
+      case 0x61: // spm_dma_out_func
+        return spmDma(tc, args[0], args[1], args[2], args[3], false);
+
+      case 0x62: // spm_dma_wait_func
+        return spmDmaWait(tc, args[0]);
+
+      case 0x63: // spm_size_func
+        return spmSize(tc);
+
       case 0x55: // annotate_func
       case 0x56: // reserved2_func
       case 0x57: // reserved3_func
@@ -706,4 +731,154 @@ workend(ThreadContext *tc, uint64_t workid, uint64_t threadid)
     }
 }
 
+//
+// Resize the scratchpad of the calling cpu by handing it ways of the L1
+// data cache.  The request is queued with the cache controller and takes
+// effect once the lines in the ways have been written back.
+//
+uint64_t
+spmConfig(ThreadContext *tc, uint64_t ways)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmConfig(%i)\n", ways);
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL) {
+        warn("spm_config: cpu %d has no scratchpad\n", tc->cpuId());
+        return 0;
+    }
+
+    return spm->partition(ways) ? 1 : 0;
+}
+
+//
+// Map [base, base + size) onto the calling cpu's scratchpad at offset,
+// through entry index of its region table.  A size of zero unmaps the
+// entry.
+//
+uint64_t
+spmRegion(ThreadContext *tc, uint64_t index, Addr base, Addr size,
+          Addr offset)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmRegion(%i, %#x, %#x, %#x)\n",
+            index, base, size, offset);
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL) {
+        warn("spm_region: cpu %d has no scratchpad\n", tc->cpuId());
+        return 0;
+    }
+
+    return spm->setRegion(index, base, size, offset) ? 1 : 0;
+}
+
+//
+// Map [base, base + size) onto the calling cpu's scratchpad at offset
+// through a free entry of its region table.  Returns the entry, or -1 if
+// the mapping was rejected.
+//
+uint64_t
+spmMap(ThreadContext *tc, Addr base, Addr size, Addr offset)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmMap(%#x, %#x, %#x)\n",
+            base, size, offset);
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL) {
+        warn("spm_map: cpu %d has no scratchpad\n", tc->cpuId());
+        return (uint64_t)-1;
+    }
+
+    return (int64_t)spm->mapRegion(base, size, offset);
+}
+
+//
+// Unmap the region of the calling cpu's scratchpad that starts at base.
+//
+uint64_t
+spmUnmap(ThreadContext *tc, Addr base)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmUnmap(%#x)\n", base);
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL) {
+        warn("spm_unmap: cpu %d has no scratchpad\n", tc->cpuId());
+        return 0;
+    }
+
+    return spm->unmapRegion(base) ? 1 : 0;
+}
+
+//
+// Start a transfer between memory and the calling cpu's scratchpad.
+// Returns an id to pass to spm_dma_wait, or -1 if the transfer was
+// rejected.
+//
+uint64_t
+spmDma(ThreadContext *tc, Addr src, Addr dst, Addr length, Addr stride,
+       bool move_in)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmDma(%#x, %#x, %#x, %#x, %s)\n",
+            src, dst, length, stride, move_in ? "in" : "out");
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL) {
+        warn("spm_dma: cpu %d has no scratchpad\n", tc->cpuId());
+        return (uint64_t)-1;
+    }
+
+    return (int64_t)spm->startDma(src, dst, length, stride, move_in);
+}
+
+//
+// Returns 1 once transfer id of the calling cpu's scratchpad has
+// completed and 0 while it is in flight, so that software can poll.  In
+// full system with quiescing enabled the cpu instead sleeps until the
+// transfer completes, and 1 is returned straight away.
+//
+uint64_t
+spmDmaWait(ThreadContext *tc, uint64_t id)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmDmaWait(%i)\n", id);
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL) {
+        warn("spm_dma_wait: cpu %d has no scratchpad\n", tc->cpuId());
+        return 1;
+    }
+
+    BaseCPU *cpu = tc->getCpuPtr();
+    if (!FullSystem || !cpu->params()->do_quiesce)
+        return spm->waitDma(id, NULL) ? 1 : 0;
+
+    EndQuiesceEvent *quiesceEvent = tc->getQuiesceEvent();
+    if (quiesceEvent->scheduled())
+        cpu->deschedule(quiesceEvent);
+    if (spm->waitDma(id, quiesceEvent)) {
+        // Already complete
+        return 1;
+    }
+
+    DPRINTF(Quiesce, "%s: spmDmaWait(%i)\n", cpu->name(), id);
+
+    tc->suspend();
+    if (tc->getKernelStats())
+        tc->getKernelStats()->quiesce();
+    return 1;
+}
+
+//
+// Bytes currently mapped onto the calling cpu's scratchpad.
+//
+uint64_t
+spmSize(ThreadContext *tc)
+{
+    DPRINTF(PseudoInst, "PseudoInst::spmSize()\n");
+
+    SpmControl *spm = SpmControl::lookup(tc->cpuId());
+    if (spm == NULL)
+        return 0;
+
+    return spm->getSize();
+}
+
 } // namespace PseudoInst
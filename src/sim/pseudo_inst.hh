@@ -88,6 +88,15 @@ void debugbreak(ThreadContext *tc);
 void switchcpu(ThreadContext *tc);
 void workbegin(ThreadContext *tc, uint64_t workid, uint64_t threadid);
 void workend(ThreadContext *tc, uint64_t workid, uint64_t threadid);
+uint64_t spmConfig(ThreadContext *tc, uint64_t ways);
+uint64_t spmRegion(ThreadContext *tc, uint64_t index, Addr base, Addr size,
+                   Addr offset);
+uint64_t spmMap(ThreadContext *tc, Addr base, Addr size, Addr offset);
+uint64_t spmUnmap(ThreadContext *tc, Addr base);
+uint64_t spmDma(ThreadContext *tc, Addr src, Addr dst, Addr length,
+                Addr stride, bool move_in);
+uint64_t spmDmaWait(ThreadContext *tc, uint64_t id);
+uint64_t spmSize(ThreadContext *tc);
 
 } // namespace PseudoInst
 
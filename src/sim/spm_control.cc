@@ -0,0 +1,34 @@
+#include "base/misc.hh"
+#include "sim/spm_control.hh"
+
+using namespace std;
+
+map<int, SpmControl *> SpmControl::spms;
+
+void
+SpmControl::registerSpm(int cpu_id, SpmControl *spm)
+{
+    map<int, SpmControl *>::iterator it = spms.find(cpu_id);
+    if (it != spms.end() && it->second != spm)
+        fatal("cpu %d already has a scratchpad\n", cpu_id);
+    spms[cpu_id] = spm;
+}
+
+void
+SpmControl::unregisterSpm(SpmControl *spm)
+{
+    for (map<int, SpmControl *>::iterator it = spms.begin();
+         it != spms.end(); ++it) {
+        if (it->second == spm) {
+            spms.erase(it);
+            return;
+        }
+    }
+}
+
+SpmControl *
+SpmControl::lookup(int cpu_id)
+{
+    map<int, SpmControl *>::iterator it = spms.find(cpu_id);
+    return it == spms.end() ? NULL : it->second;
+}
@@ -0,0 +1,90 @@
+#ifndef __SIM_SPM_CONTROL_HH__
+#define __SIM_SPM_CONTROL_HH__
+
+#include <map>
+
+#include "base/types.hh"
+
+class Event;
+
+/**
+ * Interface through which pseudo instructions reach the scratchpad of
+ * the cpu that executed them. A scratchpad registers itself under the
+ * id of the cpu it serves; the memory system owns the object, the sim
+ * layer only keeps a pointer to it.
+ */
+class SpmControl
+{
+  public:
+    virtual ~SpmControl() {}
+
+    /**
+     * Hand ways of the cpu's L1 data cache to the scratchpad, or give
+     * them back. The change takes effect once the lines held in the
+     * ways have been written back.
+     *
+     * @param ways Number of ways the scratchpad should own.
+     * @return False if the request was rejected.
+     */
+    virtual bool partition(int ways) = 0;
+
+    /**
+     * Program entry index of the scratchpad's region table so that
+     * [base, base + size) maps onto the scratchpad bytes starting at
+     * offset. A size of zero unmaps the entry. Like partition(), the
+     * change is ordered behind the cpu's earlier accesses.
+     *
+     * @return False if the request was rejected.
+     */
+    virtual bool setRegion(int index, Addr base, Addr size,
+                           Addr offset) = 0;
+
+    /**
+     * Map [base, base + size) onto the scratchpad at offset through the
+     * first region table entry that is free once the queued requests
+     * have been applied.
+     *
+     * @return The entry used, or -1 if the request was rejected.
+     */
+    virtual int mapRegion(Addr base, Addr size, Addr offset) = 0;
+
+    /**
+     * Unmap the region that will start at base once the queued requests
+     * have been applied.
+     *
+     * @return False if no region starts at base.
+     */
+    virtual bool unmapRegion(Addr base) = 0;
+
+    /**
+     * Start a DMA transfer between memory and the scratchpad. The memory
+     * side advances by stride bytes per line.
+     *
+     * @return An id to wait on, or -1 if the transfer was rejected.
+     */
+    virtual int startDma(Addr src, Addr dst, Addr length, Addr stride,
+                         bool move_in) = 0;
+
+    /**
+     * Check on transfer id. If it has not completed and wakeup is not
+     * NULL, wakeup is scheduled once it has.
+     *
+     * @return True if the transfer has completed.
+     */
+    virtual bool waitDma(int id, Event *wakeup) = 0;
+
+    /** Bytes currently mapped onto the scratchpad. */
+    virtual uint64_t getSize() const = 0;
+
+    /** Make spm the scratchpad of cpu cpu_id. */
+    static void registerSpm(int cpu_id, SpmControl *spm);
+    /** Forget spm, if it is still registered. */
+    static void unregisterSpm(SpmControl *spm);
+    /** The scratchpad of cpu cpu_id, NULL if it has none. */
+    static SpmControl *lookup(int cpu_id);
+
+  private:
+    static std::map<int, SpmControl *> spms;
+};
+
+#endif // __SIM_SPM_CONTROL_HH__
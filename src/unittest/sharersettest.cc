@@ -0,0 +1,118 @@
+#include "mem/ruby/common/SharerSet.hh"
+#include "unittest/unittest.hh"
+
+using UnitTest::setCase;
+
+static MachineID
+l1(NodeID num)
+{
+    MachineID mach = {MachineType_L1Cache, num};
+    return mach;
+}
+
+int
+main()
+{
+    setCase("A full map.");
+    SharerSet::configure(0, 0, 16);
+    SharerSet full;
+    EXPECT_TRUE(full.isEmpty());
+    EXPECT_FALSE(full.add(l1(3)));
+    EXPECT_FALSE(full.add(l1(12)));
+    EXPECT_FALSE(full.isImprecise());
+    EXPECT_EQ(full.count(), 2);
+    EXPECT_TRUE(full.isElement(l1(3)));
+    EXPECT_FALSE(full.isElement(l1(4)));
+    full.remove(l1(3));
+    EXPECT_FALSE(full.isElement(l1(3)));
+    EXPECT_EQ(full.count(), 1);
+    full.remove(l1(12));
+    EXPECT_TRUE(full.isEmpty());
+
+    setCase("A full map wider than the inline vector.");
+    SharerSet::configure(0, 0, 300);
+    SharerSet wide;
+    EXPECT_FALSE(wide.add(l1(1)));
+    EXPECT_FALSE(wide.add(l1(299)));
+    EXPECT_EQ(wide.count(), 2);
+    EXPECT_TRUE(wide.isElement(l1(299)));
+    EXPECT_FALSE(wide.isElement(l1(298)));
+    SharerSet wide_copy(wide);
+    wide.remove(l1(299));
+    EXPECT_FALSE(wide.isElement(l1(299)));
+    EXPECT_TRUE(wide_copy.isElement(l1(299)));
+    wide.clear();
+    EXPECT_TRUE(wide.isEmpty());
+
+    setCase("Overflowing the pointers.");
+    // 16 L1s in 4 groups of 4
+    SharerSet::configure(2, 4, 16);
+    SharerSet limited;
+    EXPECT_FALSE(limited.add(l1(1)));
+    EXPECT_FALSE(limited.add(l1(5)));
+    // Adding a sharer twice takes no pointer
+    EXPECT_FALSE(limited.add(l1(1)));
+    EXPECT_FALSE(limited.isImprecise());
+    EXPECT_EQ(limited.count(), 2);
+    EXPECT_TRUE(limited.isElement(l1(5)));
+    EXPECT_FALSE(limited.isElement(l1(4)));
+    limited.remove(l1(5));
+    EXPECT_FALSE(limited.isElement(l1(5)));
+    EXPECT_FALSE(limited.add(l1(5)));
+    EXPECT_TRUE(limited.add(l1(9)));
+    EXPECT_TRUE(limited.isImprecise());
+
+    setCase("Membership of coarse groups.");
+    // Groups 0, 1 and 2 now stand for L1s 0-11
+    EXPECT_EQ(limited.count(), 12);
+    EXPECT_TRUE(limited.isElement(l1(0)));
+    EXPECT_TRUE(limited.isElement(l1(2)));
+    EXPECT_TRUE(limited.isElement(l1(11)));
+    EXPECT_FALSE(limited.isElement(l1(12)));
+    EXPECT_FALSE(limited.isElement(l1(15)));
+    EXPECT_FALSE(limited.add(l1(14)));
+    EXPECT_EQ(limited.count(), 16);
+
+    setCase("Removing from coarse groups.");
+    // A group bit may stand for other sharers, so it stays set
+    limited.remove(l1(1));
+    EXPECT_TRUE(limited.isElement(l1(1)));
+    EXPECT_EQ(limited.count(), 16);
+    SharerSet assigned;
+    assigned = limited;
+    EXPECT_TRUE(assigned.isImprecise());
+    EXPECT_EQ(assigned.count(), 16);
+    limited.clear();
+    EXPECT_TRUE(limited.isEmpty());
+    EXPECT_FALSE(limited.isImprecise());
+    EXPECT_FALSE(limited.add(l1(1)));
+    EXPECT_EQ(limited.count(), 1);
+
+    setCase("A short last group.");
+    // 10 L1s in groups of 4, 4 and 2
+    SharerSet::configure(1, 3, 10);
+    SharerSet ragged;
+    EXPECT_FALSE(ragged.add(l1(0)));
+    EXPECT_TRUE(ragged.add(l1(9)));
+    EXPECT_EQ(ragged.count(), 6);
+    EXPECT_TRUE(ragged.isElement(l1(8)));
+    EXPECT_FALSE(ragged.isElement(l1(7)));
+
+    setCase("Broadcast with sharer_vector_bits = 0.");
+    SharerSet::configure(2, 0, 16);
+    SharerSet broadcast;
+    EXPECT_FALSE(broadcast.add(l1(0)));
+    EXPECT_FALSE(broadcast.add(l1(1)));
+    EXPECT_EQ(broadcast.count(), 2);
+    EXPECT_TRUE(broadcast.add(l1(2)));
+    EXPECT_TRUE(broadcast.isImprecise());
+    EXPECT_EQ(broadcast.count(), 16);
+    EXPECT_TRUE(broadcast.isElement(l1(15)));
+    broadcast.remove(l1(0));
+    EXPECT_TRUE(broadcast.isElement(l1(0)));
+    EXPECT_EQ(broadcast.count(), 16);
+    broadcast.clear();
+    EXPECT_TRUE(broadcast.isEmpty());
+
+    return UnitTest::printResults();
+}
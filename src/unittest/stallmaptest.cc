@@ -0,0 +1,205 @@
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/ruby/buffers/StallMap.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+// A message that only carries a number to tell it apart by
+class TestMessage : public Message
+{
+  public:
+    TestMessage(Tick id) : Message(id) {}
+
+    Message *clone() const { return new TestMessage(*this); }
+    void print(ostream& out) const 
+    { out << "[TestMessage " << getTime() << "]"; }
+    bool functionalRead(Packet *pkt) { return false; }
+    bool functionalWrite(Packet *pkt) { return false; }
+};
+
+static MsgPtr
+msg(Tick id)
+{
+    return new TestMessage(id);
+}
+
+static Address
+line(Addr n)
+{
+    return Address(n << 6);
+}
+
+// The slot a line hashes to while the map still has its initial 16
+// slots, as StallMap::home() computes it
+static unsigned
+initialHome(Addr n)
+{
+    return (line(n).getAddress() * ULL(0x9e3779b97f4a7c15)) >> 60;
+}
+
+// The ids of the released messages, in the order they were released
+static vector<Tick>
+ids(const vector<MsgPtr>& out)
+{
+    vector<Tick> v;
+    for (int i = 0; i < (int)out.size(); i++)
+        v.push_back(out[i]->getTime());
+    return v;
+}
+
+static vector<Tick>
+ids(Tick a, Tick b = 0, Tick c = 0, Tick d = 0)
+{
+    vector<Tick> v;
+    Tick all[] = { a, b, c, d };
+    for (int i = 0; i < 4 && all[i] != 0; i++)
+        v.push_back(all[i]);
+    return v;
+}
+
+int
+main()
+{
+    vector<MsgPtr> out;
+
+    setCase("An empty map.");
+    StallMap empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_FALSE(empty.contains(line(1)));
+    EXPECT_EQ(empty.release(line(1), out), 0);
+    EXPECT_EQ(empty.releaseAll(out), 0);
+    EXPECT_TRUE(out.empty());
+
+    setCase("Inserting and releasing.");
+    StallMap map1;
+    EXPECT_EQ(map1.push(line(1), msg(1)), 1);
+    EXPECT_EQ(map1.push(line(2), msg(2)), 1);
+    EXPECT_EQ(map1.push(line(1), msg(3)), 2);
+    EXPECT_EQ(map1.push(line(1), msg(4)), 3);
+    EXPECT_FALSE(map1.empty());
+    EXPECT_TRUE(map1.contains(line(1)));
+    EXPECT_TRUE(map1.contains(line(2)));
+    EXPECT_FALSE(map1.contains(line(3)));
+
+    EXPECT_EQ(map1.release(line(1), out), 3);
+    EXPECT_TRUE(ids(out) == ids(1, 3, 4));
+    EXPECT_FALSE(map1.contains(line(1)));
+    EXPECT_TRUE(map1.contains(line(2)));
+    EXPECT_EQ(map1.release(line(1), out), 0);
+
+    out.clear();
+    EXPECT_EQ(map1.release(line(2), out), 1);
+    EXPECT_TRUE(ids(out) == ids(2));
+    EXPECT_TRUE(map1.empty());
+
+    // The freed list and nodes are reused
+    out.clear();
+    EXPECT_EQ(map1.push(line(3), msg(5)), 1);
+    EXPECT_EQ(map1.push(line(3), msg(6)), 2);
+    EXPECT_EQ(map1.release(line(3), out), 2);
+    EXPECT_TRUE(ids(out) == ids(5, 6));
+    EXPECT_TRUE(map1.empty());
+
+    setCase("Erasing from a probe chain.");
+    // Three lines with the same home and one homed right after them, so
+    // that it is pushed along the chain too
+    vector<Addr> same;
+    for (Addr n = 1; same.size() < 3; n++) {
+        if (initialHome(n) == initialHome(0))
+            same.push_back(n);
+    }
+    Addr next = 1;
+    while (initialHome(next) != ((initialHome(0) + 1) & 15))
+        next++;
+
+    StallMap map2;
+    map2.push(line(0), msg(1));
+    map2.push(line(same[0]), msg(2));
+    map2.push(line(same[1]), msg(3));
+    map2.push(line(next), msg(4));
+    map2.push(line(same[2]), msg(5));
+
+    // Erase the head of the chain, then the middle, then the end
+    out.clear();
+    EXPECT_EQ(map2.release(line(0), out), 1);
+    EXPECT_FALSE(map2.contains(line(0)));
+    EXPECT_TRUE(map2.contains(line(same[0])));
+    EXPECT_TRUE(map2.contains(line(same[1])));
+    EXPECT_TRUE(map2.contains(line(same[2])));
+    EXPECT_TRUE(map2.contains(line(next)));
+
+    EXPECT_EQ(map2.release(line(same[1]), out), 1);
+    EXPECT_TRUE(map2.contains(line(same[0])));
+    EXPECT_FALSE(map2.contains(line(same[1])));
+    EXPECT_TRUE(map2.contains(line(same[2])));
+    EXPECT_TRUE(map2.contains(line(next)));
+
+    EXPECT_EQ(map2.release(line(same[2]), out), 1);
+    EXPECT_TRUE(map2.contains(line(same[0])));
+    EXPECT_TRUE(map2.contains(line(next)));
+
+    EXPECT_EQ(map2.release(line(next), out), 1);
+    EXPECT_EQ(map2.release(line(same[0]), out), 1);
+    vector<Tick> expected = ids(1, 3, 5, 4);
+    expected.push_back(2);
+    EXPECT_TRUE(ids(out) == expected);
+    EXPECT_TRUE(map2.empty());
+
+    setCase("Growing the table.");
+    StallMap map3;
+    for (Addr n = 0; n < 100; n++) {
+        EXPECT_EQ(map3.push(line(n), msg(n + 1)), 1);
+        // An earlier list stays reachable while the table grows
+        EXPECT_EQ(map3.push(line(n / 2), msg(1000 + n)),
+                  n % 2 == 0 ? 2 : 3);
+    }
+    bool found = true;
+    for (Addr n = 0; n < 100; n++)
+        found = found && map3.contains(line(n));
+    EXPECT_TRUE(found);
+    EXPECT_FALSE(map3.contains(line(100)));
+
+    // Releasing every other line leaves the rest to be found
+    out.clear();
+    int released = 0;
+    for (Addr n = 0; n < 100; n += 2)
+        released += map3.release(line(n), out);
+    EXPECT_EQ(released, 100);
+    found = true;
+    for (Addr n = 0; n < 100; n++)
+        found = found && map3.contains(line(n)) == (n % 2 == 1);
+    EXPECT_TRUE(found);
+
+    setCase("Releasing every list in the order they were opened.");
+    StallMap map4;
+    map4.push(line(7), msg(1));
+    map4.push(line(3), msg(2));
+    map4.push(line(9), msg(3));
+    map4.push(line(7), msg(4));
+    // Reopening a released line puts its list last
+    out.clear();
+    map4.release(line(3), out);
+    map4.push(line(3), msg(5));
+    map4.push(line(9), msg(6));
+
+    out.clear();
+    EXPECT_EQ(map4.releaseAll(out), 5);
+    expected = ids(1, 4, 3, 6);
+    expected.push_back(5);
+    EXPECT_TRUE(ids(out) == expected);
+    EXPECT_TRUE(map4.empty());
+    EXPECT_FALSE(map4.contains(line(7)));
+
+    // The map is usable again after being cleared
+    map4.push(line(1), msg(7));
+    map4.clear();
+    EXPECT_TRUE(map4.empty());
+    EXPECT_FALSE(map4.contains(line(1)));
+    EXPECT_EQ(map4.push(line(1), msg(8)), 1);
+    EXPECT_TRUE(map4.contains(line(1)));
+
+    return UnitTest::printResults();
+}
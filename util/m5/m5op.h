@@ -62,6 +62,23 @@ void m5_panic(void);
 void m5_work_begin(uint64_t workid, uint64_t threadid);
 void m5_work_end(uint64_t workid, uint64_t threadid);
 
+// Hand ways of the L1 data cache to the scratchpad; returns 0 if refused
+uint64_t m5_spm_config(uint64_t ways);
+uint64_t m5_spm_region(uint64_t index, uint64_t base, uint64_t size,
+                       uint64_t offset);
+// Map a range through a free region; returns the region or -1
+int64_t m5_spm_map(uint64_t base, uint64_t size, uint64_t offset);
+uint64_t m5_spm_unmap(uint64_t base);
+// Start a DMA transfer, the stride applies to the memory side; returns
+// a transfer id or -1
+int64_t m5_spm_dma_in(uint64_t mem_src, uint64_t spm_dst, uint64_t len,
+                      uint64_t stride);
+int64_t m5_spm_dma_out(uint64_t spm_src, uint64_t mem_dst, uint64_t len,
+                       uint64_t stride);
+// Returns 1 once the transfer has completed, 0 if software should poll
+uint64_t m5_spm_dma_wait(int64_t id);
+uint64_t m5_spm_size(void);
+
 // These operations are for critical path annotation
 void m5a_bsm(char *sm, const void *id, int flags);
 void m5a_esm(char *sm);
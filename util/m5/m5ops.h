@@ -62,6 +62,16 @@
 #define work_begin_func          0x5a
 #define work_end_func            0x5b
 
+// These operations control the scratchpad of the calling cpu
+#define spm_config_func          0x5c
+#define spm_region_func          0x5d
+#define spm_map_func             0x5e
+#define spm_unmap_func           0x5f
+#define spm_dma_in_func          0x60
+#define spm_dma_out_func         0x61
+#define spm_dma_wait_func        0x62
+#define spm_size_func            0x63
+
 // These operations are for critical path annotation
 #define annotate_func     0x55
 #define an_bsm            0x1
@@ -0,0 +1,77 @@
+#! /usr/bin/env python
+
+# Measures how fast Ruby consumers are woken on a 64 node garnet mesh.
+# Pass one or more gem5 binaries built with the Network_test protocol,
+# e.g. one from before and one from after a change to the wakeup path:
+#
+#   util/ruby_wakeup_bench.py build/X86_NT/gem5.opt.old \
+#       build/X86_NT/gem5.opt
+#
+# Every binary runs the same synthetic traffic, so the binaries are
+# compared by host seconds and by simulated ticks per host second, which
+# every build reports.  A change to the wakeup path may change how many
+# wakeups that traffic takes, so the consumer_wakeups count and rate are
+# shown only for the binaries that report the statistic, each with its
+# own count.
+
+import optparse
+import os
+import re
+import subprocess
+import sys
+
+parser = optparse.OptionParser(usage="%prog [options] gem5-binary...")
+parser.add_option("--sim-cycles", type="int", default=100000,
+                  help="Cycles of traffic to simulate")
+parser.add_option("-i", "--injectionrate", type="float", default=0.1,
+                  help="Packets injected per node per cycle")
+parser.add_option("--garnet-network", type="choice", default="fixed",
+                  choices=["fixed", "flexible"])
+parser.add_option("--outdir", default="m5out-wakeup-bench",
+                  help="Directory to keep the output of each run in")
+(options, binaries) = parser.parse_args()
+
+if not binaries:
+    parser.error("no gem5 binaries given")
+
+gem5_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+config = os.path.join(gem5_root, "configs", "example",
+                      "ruby_network_test.py")
+
+def stat(stats, name):
+    m = re.search(r"^\S*%s\s+(\S+)" % re.escape(name), stats, re.M)
+    if m:
+        return float(m.group(1))
+    return None
+
+results = []
+for i, binary in enumerate(binaries):
+    outdir = os.path.join(options.outdir, str(i))
+    cmd = [binary, "-d", outdir, config,
+           "--num-cpus=64", "--num-dirs=64",
+           "--topology=Mesh", "--mesh-rows=8",
+           "--garnet-network=%s" % options.garnet_network,
+           "--sim-cycles=%d" % options.sim_cycles,
+           "--injectionrate=%f" % options.injectionrate]
+    print "running %s" % binary
+    if subprocess.call(cmd, stdout=open(os.devnull, "w")) != 0:
+        print >>sys.stderr, "%s failed, see %s" % (binary, outdir)
+        sys.exit(1)
+    stats = open(os.path.join(outdir, "stats.txt")).read()
+    results.append((binary, stat(stats, "host_seconds"),
+                    stat(stats, "sim_ticks"),
+                    stat(stats, "consumer_wakeups")))
+
+base_seconds = results[0][1]
+print
+print "%-40s %12s %8s %14s %14s %14s" % ("binary", "host seconds",
+                                          "speedup", "ticks/s", "wakeups",
+                                          "wakeups/s")
+for (binary, seconds, ticks, count) in results:
+    if count is None:
+        wakeups = "%14s %14s" % ("-", "-")
+    else:
+        wakeups = "%14d %14.0f" % (count, count / seconds)
+    print "%-40s %12.2f %8.2f %14.0f %s" % (binary, seconds,
+                                             base_seconds / seconds,
+                                             ticks / seconds, wakeups)